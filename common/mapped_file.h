@@ -0,0 +1,148 @@
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "utils.h"
+
+namespace aoc {
+
+// Read-only memory mapping of a whole input file, for inputs too large to copy into strings.
+class MappedFile {
+   public:
+    explicit MappedFile(const fs::path& path) {
+        fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) throw std::runtime_error("Unable to open file: " + path.string());
+
+        struct stat info{};
+        if (fstat(fd, &info) != 0) {
+            close(fd);
+            throw std::runtime_error("Unable to stat file: " + path.string());
+        }
+        size = static_cast<size_t>(info.st_size);
+        if (size == 0) {
+            close(fd);
+            throw std::runtime_error("File empty");
+        }
+
+        void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) {
+            close(fd);
+            throw std::runtime_error("Unable to map file: " + path.string() + " (" +
+                                     std::strerror(errno) + ")");
+        }
+        data = static_cast<const char*>(mapped);
+        madvise(mapped, size, MADV_SEQUENTIAL);
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile() {
+        munmap(const_cast<char*>(data), size);
+        close(fd);
+    }
+
+    std::string_view view() const {
+        return {data, size};
+    }
+
+   private:
+    int fd = -1;
+    const char* data = nullptr;
+    size_t size = 0;
+};
+
+// Writable scratch space backed by an unlinked temporary file in `directory`, so state larger
+// than RAM can be paged out by the kernel instead of living on the heap. Starts zero-filled.
+class ScratchMapping {
+   public:
+    ScratchMapping(const fs::path& directory, size_t bytes) : size(bytes) {
+        std::string path = (directory / "aoc_scratch_XXXXXX").string();
+        fd = mkstemp(path.data());
+        if (fd < 0) {
+            throw std::runtime_error("Unable to create scratch file in " + directory.string());
+        }
+        unlink(path.c_str());
+
+        if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+            close(fd);
+            throw std::runtime_error("Unable to size scratch file");
+        }
+
+        void* mapped = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (mapped == MAP_FAILED) {
+            close(fd);
+            throw std::runtime_error(std::string("Unable to map scratch file (") +
+                                     std::strerror(errno) + ")");
+        }
+        data = static_cast<char*>(mapped);
+    }
+
+    ScratchMapping(const ScratchMapping&) = delete;
+    ScratchMapping& operator=(const ScratchMapping&) = delete;
+
+    ~ScratchMapping() {
+        munmap(data, size);
+        close(fd);
+    }
+
+    template <typename T>
+    T* as() const {
+        return reinterpret_cast<T*>(data);
+    }
+
+   private:
+    int fd = -1;
+    char* data = nullptr;
+    size_t size = 0;
+};
+
+inline fs::path resolve_file(const fs::path& filename, std::string_view context = "") {
+    auto resolvedPath = find_file(filename, context);
+    if (!resolvedPath) {
+        std::cerr << "[Error] Could not find file: " << filename << "\n";
+        throw std::runtime_error("File not found");
+    }
+    return *resolvedPath;
+}
+
+// Calls fn(line) for every line in [data.begin(), data.end()), without the trailing '\n'.
+template <typename Fn>
+void for_each_line(std::string_view data, Fn&& fn) {
+    while (!data.empty()) {
+        const size_t newline = data.find('\n');
+        if (newline == std::string_view::npos) {
+            fn(data);
+            return;
+        }
+        fn(data.substr(0, newline));
+        data.remove_prefix(newline + 1);
+    }
+}
+
+// Splits `data` into at most `parts` pieces that each end right after a '\n' (or at the end).
+inline std::vector<std::string_view> split_at_lines(std::string_view data, size_t parts) {
+    std::vector<std::string_view> chunks;
+    if (parts == 0) parts = 1;
+    const size_t target = data.size() / parts + 1;
+
+    while (!data.empty()) {
+        size_t cut = std::min(target, data.size());
+        const size_t newline = data.find('\n', cut - 1);
+        cut = (newline == std::string_view::npos) ? data.size() : newline + 1;
+        chunks.push_back(data.substr(0, cut));
+        data.remove_prefix(cut);
+    }
+    return chunks;
+}
+
+}  // namespace aoc
\ No newline at end of file
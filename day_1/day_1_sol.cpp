@@ -1,8 +1,17 @@
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
 #include <charconv>
 #include <chrono>
+#include <csignal>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <limits>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -24,6 +33,15 @@ struct SimulationResult {
     long long part2;
 };
 
+constexpr size_t STREAM_CHUNK = 64 * 1024;
+constexpr int DEFAULT_REPORT_INTERVAL_MS = 1000;
+
+volatile std::sig_atomic_t report_requested = 0;
+
+void on_report_signal(int) {
+    report_requested = 1;
+}
+
 std::vector<char> load_file(const fs::path& filePath) {
     std::ifstream file(filePath, std::ios::binary | std::ios::ate);
     if (!file) {
@@ -115,8 +133,152 @@ SimulationResult process_instructions(std::string_view data) {
     return {p1_hits, p2_hits};
 }
 
+// Incremental parser for an unbounded instruction stream. Bytes can be fed in arbitrary
+// chunks; a record split across two chunks is carried in `direction`/`value`, so memory stays
+// constant no matter how long the stream runs.
+class DialStream {
+   public:
+    void feed(const char* ptr, const char* end) {
+        for (; ptr < end; ++ptr) {
+            const char c = *ptr;
+
+            if (c >= '0' && c <= '9') {
+                if (direction != 0) {
+                    // An over-long record becomes a zero move, as in file mode, where
+                    // std::from_chars reports out-of-range and leaves the value at 0.
+                    if (value > (std::numeric_limits<int>::max() - (c - '0')) / 10) {
+                        too_long = true;
+                    } else {
+                        value = value * 10 + (c - '0');
+                    }
+                    has_value = true;
+                }
+                continue;
+            }
+
+            flush();
+
+            if (static_cast<unsigned char>(c) > ' ') {
+                direction = c;
+            }
+        }
+    }
+
+    // Applies a record still waiting for its terminator (end of stream without a newline).
+    void flush() {
+        if (direction != 0 && has_value) {
+            StepResult step = update_dial(dial, direction, too_long ? 0 : value);
+            dial = step.final_pos;
+            result.part2 += step.intermediate_zeros;
+            if (dial == 0) {
+                result.part1++;
+            }
+            records++;
+        }
+        direction = 0;
+        value = 0;
+        has_value = false;
+        too_long = false;
+    }
+
+    const SimulationResult& counters() const {
+        return result;
+    }
+
+    long long processed() const {
+        return records;
+    }
+
+   private:
+    int dial = DIAL_START;
+    char direction = 0;
+    int value = 0;
+    bool has_value = false;
+    bool too_long = false;
+    long long records = 0;
+    SimulationResult result{0, 0};
+};
+
+void print_counters(const DialStream& stream) {
+    const auto& counters = stream.counters();
+    std::println("[{} records] Part 1: {} Part 2: {}", stream.processed(), counters.part1,
+                 counters.part2);
+    std::cout.flush();
+}
+
+// Reads `source` ("-" for stdin, otherwise a file or FIFO) until EOF, printing the live
+// counters every `interval_ms` milliseconds and whenever SIGUSR1 arrives.
+SimulationResult stream_instructions(const std::string& source, int interval_ms) {
+    int fd = STDIN_FILENO;
+    if (source != "-") {
+        fd = open(source.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Unable to open stream: " + source + " (" +
+                                     std::strerror(errno) + ")");
+        }
+    }
+
+    struct sigaction action{};
+    action.sa_handler = on_report_signal;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGUSR1, &action, nullptr);
+
+    DialStream stream;
+    std::vector<char> chunk(STREAM_CHUNK);
+    auto next_report = std::chrono::steady_clock::now() + std::chrono::milliseconds(interval_ms);
+
+    while (true) {
+        const auto now = std::chrono::steady_clock::now();
+        if (report_requested || (interval_ms > 0 && now >= next_report)) {
+            report_requested = 0;
+            print_counters(stream);
+            next_report = now + std::chrono::milliseconds(interval_ms);
+        }
+
+        int timeout = -1;
+        if (interval_ms > 0) {
+            const auto remaining =
+                std::chrono::duration_cast<std::chrono::milliseconds>(next_report - now).count();
+            timeout = static_cast<int>(std::max<long long>(remaining, 0));
+        }
+
+        pollfd pfd{fd, POLLIN, 0};
+        int ready = poll(&pfd, 1, timeout);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error(std::string("poll failed: ") + std::strerror(errno));
+        }
+        if (ready == 0) continue;
+
+        ssize_t n = read(fd, chunk.data(), chunk.size());
+        if (n < 0) {
+            if (errno == EINTR || errno == EAGAIN) continue;
+            throw std::runtime_error(std::string("read failed: ") + std::strerror(errno));
+        }
+        if (n == 0) break;
+
+        stream.feed(chunk.data(), chunk.data() + n);
+    }
+
+    if (fd != STDIN_FILENO) close(fd);
+
+    stream.flush();
+    return stream.counters();
+}
+
 int main(int argc, char* argv[]) {
     try {
+        if (argc > 1 && std::string_view(argv[1]) == "--stream") {
+            std::string source = (argc > 2) ? argv[2] : "-";
+            int interval_ms = (argc > 3) ? std::stoi(argv[3]) : DEFAULT_REPORT_INTERVAL_MS;
+
+            SimulationResult result = stream_instructions(source, interval_ms);
+
+            std::println("Part 1: {}", result.part1);
+            std::println("Part 2: {}", result.part2);
+            return 0;
+        }
+
         std::string filename = (argc > 1) ? argv[1] : "input.txt";
 
         std::vector<char> buffer = load_file(filename);
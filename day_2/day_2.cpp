@@ -1,10 +1,15 @@
+#include <algorithm>
+#include <array>
+#include <bit>
 #include <charconv>
+#include <execution>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <ranges>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 #include "utils.h"
@@ -50,66 +55,433 @@ std::vector<Range> parse_file(std::string_view content) {
     return std::vector<Range>(view.begin(), view.end());
 }
 
-bool is_repeated_pattern(long long n) {
-    char buf[24];
-    auto [ptr, ec] = std::to_chars(buf, buf + sizeof(buf), n);
-    std::string_view s(buf, ptr - buf);
-
-    int len = s.length();
-
-    for (int sub_len = 1; sub_len <= len / 2; ++sub_len) {
-        if (len % sub_len == 0) {
-            bool match = true;
-            for (int i = sub_len; i < len; ++i) {
-                if (s[i] != s[i - sub_len]) {
-                    match = false;
-                    break;
-                }
-            }
-            if (match) return true;
-        }
+constexpr int MAX_DIGITS = 19;
+
+constexpr auto POW10 = [] {
+    std::array<unsigned long long, MAX_DIGITS + 1> table{};
+    table[0] = 1;
+    for (int i = 1; i <= MAX_DIGITS; ++i) table[i] = table[i - 1] * 10;
+    return table;
+}();
+
+constexpr int digit_count(unsigned long long n) {
+    // bit_width * log10(2) guesses the length, one table lookup corrects it.
+    int guess = (std::bit_width(n) * 1233) >> 12;
+    return guess + (n >= POW10[guess]);
+}
+
+// (10^len - 1) / (10^p - 1): the multiplier that repeats a p-digit block to len digits.
+constexpr unsigned long long repunit(int len, int p) {
+    return (POW10[len] - 1) / (POW10[p] - 1);
+}
+
+constexpr bool is_prime(int n) {
+    if (n < 2) return false;
+    for (int d = 2; d * d <= n; ++d) {
+        if (n % d == 0) return false;
     }
-    return false;
+    return true;
 }
 
-bool is_double_repeated(long long n) {
-    std::string s = std::to_string(n);
-    if (s.length() % 2 != 0) {
+// --- Arithmetic predicates, one kernel per digit length ---
+//
+// A LEN-digit number repeats a p-digit block exactly when it is divisible by repunit(LEN, p).
+// Any period also implies every multiple of it that divides LEN, so it is enough to test the
+// periods LEN / q for the primes q dividing LEN.
+
+template <int LEN>
+constexpr bool is_double_repeated_len(unsigned long long n) {
+    if constexpr (LEN % 2 != 0) {
         return false;
+    } else {
+        return n % repunit(LEN, LEN / 2) == 0;
+    }
+}
+
+template <int LEN>
+constexpr bool is_repeated_pattern_len(unsigned long long n) {
+    return [n]<int... Q>(std::integer_sequence<int, Q...>) {
+        return ((is_prime(Q) && LEN % Q == 0 && n % repunit(LEN, LEN / Q) == 0) || ...);
+    }(std::make_integer_sequence<int, LEN + 1>{});
+}
+
+// Bit i of each mask is set when n + i matches. Every multiplier is at least 11, so it has at
+// most one multiple in the 8-wide window: one division per multiplier covers all 8 numbers.
+// The caller guarantees that n .. n + 7 all have LEN digits.
+template <int LEN>
+constexpr std::pair<unsigned, unsigned> match_masks_x8(unsigned long long n) {
+    auto window_hit = [n](unsigned long long multiplier) -> unsigned {
+        unsigned long long offset = (multiplier - n % multiplier) % multiplier;
+        return offset < 8 ? 1u << offset : 0u;
+    };
+
+    unsigned double_mask = 0;
+    if constexpr (LEN % 2 == 0) {
+        double_mask = window_hit(repunit(LEN, LEN / 2));
+    }
+
+    unsigned pattern_mask = [&]<int... Q>(std::integer_sequence<int, Q...>) {
+        return ((is_prime(Q) && LEN % Q == 0 ? window_hit(repunit(LEN, LEN / Q)) : 0u) | ...);
+    }(std::make_integer_sequence<int, LEN + 1>{});
+
+    return {double_mask, pattern_mask};
+}
+
+constexpr unsigned long long masked_sum_x8(unsigned long long n, unsigned mask) {
+    unsigned long long sum = 0;
+    while (mask != 0) {
+        sum += n + std::countr_zero(mask);
+        mask &= mask - 1;
+    }
+    return sum;
+}
+
+// Brute-force sums over [lo, hi], where every number in the interval has LEN digits.
+template <int LEN>
+std::pair<unsigned long long, unsigned long long> scan_length(unsigned long long lo,
+                                                              unsigned long long hi) {
+    unsigned long long sum_of_double_repeated = 0;
+    unsigned long long sum_of_repeated_pattern = 0;
+
+    unsigned long long n = lo;
+    if constexpr (LEN > 1) {
+        for (; n <= hi && hi - n >= 7; n += 8) {
+            auto [double_mask, pattern_mask] = match_masks_x8<LEN>(n);
+            sum_of_double_repeated += masked_sum_x8(n, double_mask);
+            sum_of_repeated_pattern += masked_sum_x8(n, pattern_mask);
+        }
+    }
+    for (; n <= hi; ++n) {
+        if (is_double_repeated_len<LEN>(n)) sum_of_double_repeated += n;
+        if (is_repeated_pattern_len<LEN>(n)) sum_of_repeated_pattern += n;
     }
-    auto half = s.length() / 2;
-    return std::string_view(s).substr(0, half) == std::string_view(s).substr(half);
+
+    return {sum_of_double_repeated, sum_of_repeated_pattern};
 }
 
+using PredicateFn = bool (*)(unsigned long long);
+using ScanFn = std::pair<unsigned long long, unsigned long long> (*)(unsigned long long,
+                                                                      unsigned long long);
+
+template <int... LEN>
+constexpr auto make_kernel_tables(std::integer_sequence<int, LEN...>) {
+    struct Tables {
+        std::array<PredicateFn, sizeof...(LEN)> double_repeated;
+        std::array<PredicateFn, sizeof...(LEN)> repeated_pattern;
+        std::array<ScanFn, sizeof...(LEN)> scan;
+    };
+    return Tables{{&is_double_repeated_len<LEN>...},
+                  {&is_repeated_pattern_len<LEN>...},
+                  {&scan_length<LEN>...}};
+}
+
+// Indexed by digit length; entry 0 is never used.
+constexpr auto KERNELS = make_kernel_tables(std::make_integer_sequence<int, MAX_DIGITS + 1>{});
+
+bool is_repeated_pattern(long long n) {
+    if (n < 1) return false;
+    auto value = static_cast<unsigned long long>(n);
+    return KERNELS.repeated_pattern[digit_count(value)](value);
+}
+
+bool is_double_repeated(long long n) {
+    if (n < 1) return false;
+    auto value = static_cast<unsigned long long>(n);
+    return KERNELS.double_repeated[digit_count(value)](value);
+}
+
+// Reference checker: visits every number, one digit length at a time.
 std::tuple<long long, long long> loop_range_elements(const Range& r) {
     unsigned long long sum_of_double_repeated = 0;
     unsigned long long sum_of_repeated_pattern = 0;
 
-    for (auto i : std::views::iota(r.start, r.end + 1)) {
-        if (is_double_repeated(i)) {
-            sum_of_double_repeated += i;
+    if (r.end < r.start || r.end < 1) return {0, 0};
+
+    auto lo = static_cast<unsigned long long>(std::max(r.start, 1LL));
+    const auto hi = static_cast<unsigned long long>(r.end);
+
+    while (lo <= hi) {
+        const int len = digit_count(lo);
+        const unsigned long long segment_end = std::min(hi, POW10[len] - 1);
+
+        auto [x, y] = KERNELS.scan[len](lo, segment_end);
+        sum_of_double_repeated += x;
+        sum_of_repeated_pattern += y;
+
+        if (segment_end == hi) break;
+        lo = segment_end + 1;
+    }
+
+    return {sum_of_double_repeated, sum_of_repeated_pattern};
+}
+
+// --- Closed-form engine ---
+//
+// Every number of `len` digits in base B that repeats a block of `p` digits (p | len) is
+// block * R, where R = (B^len - 1) / (B^p - 1) is the repunit multiplier 1 0..01 0..01.
+// The valid blocks inside a range form a contiguous interval, so their count and sum come
+// from an arithmetic series and no number in the range has to be visited.
+
+constexpr int MAX_LEN = 64;
+constexpr int UNBOUNDED_REPEATS = MAX_LEN;
+
+struct QueryResult {
+    unsigned long long count;
+    unsigned long long sum;
+};
+
+// max_value[len] = B^len - 1, up to the longest length whose values fit in 64 bits.
+struct PowerTable {
+    unsigned base;
+    int max_len;
+    std::array<unsigned long long, MAX_LEN + 1> max_value;
+};
+
+constexpr PowerTable make_power_table(unsigned base) {
+    PowerTable table{base, 0, {}};
+    unsigned long long value = 0;
+    while (table.max_len < MAX_LEN && value <= (~0ULL - (base - 1)) / base) {
+        value = value * base + (base - 1);
+        table.max_value[++table.max_len] = value;
+    }
+    return table;
+}
+
+template <unsigned BASE>
+inline constexpr PowerTable POWER_TABLE = make_power_table(BASE);
+
+constexpr unsigned long long series_sum(unsigned long long first, unsigned long long last) {
+    if (first > last) return 0;
+    unsigned long long count = last - first + 1;
+    unsigned long long ends = first + last;
+    // One of the two factors is always even, halve it before multiplying.
+    return (count % 2 == 0) ? (count / 2) * ends : count * (ends / 2);
+}
+
+// Count and sum of the `len`-digit numbers in [lo, hi] (already clipped to that length) made of
+// a `p`-digit block repeated len / p times.
+constexpr QueryResult with_period(const PowerTable& t, unsigned long long lo, unsigned long long hi,
+                                  int len, int p) {
+    const unsigned long long multiplier = t.max_value[len] / t.max_value[p];
+
+    unsigned long long block_min = std::max((lo - 1) / multiplier + 1, t.max_value[p - 1] + 1);
+    unsigned long long block_max = std::min(hi / multiplier, t.max_value[p]);
+    if (block_min > block_max) return {0, 0};
+
+    return {block_max - block_min + 1, multiplier * series_sum(block_min, block_max)};
+}
+
+// Numbers in [lo, hi] that are some block repeated r times for an r in [min_repeats,
+// max_repeats]. Costs O(len^2) per digit length, independent of the width of the range.
+constexpr QueryResult query_pattern_range(const PowerTable& t, unsigned long long lo,
+                                          unsigned long long hi, int min_repeats,
+                                          int max_repeats) {
+    QueryResult total{0, 0};
+    if (lo == 0) lo = 1;
+
+    for (int len = 1; len <= t.max_len; ++len) {
+        if (t.max_value[len - 1] >= hi) break;
+        if (t.max_value[len] < lo) continue;
+
+        const unsigned long long len_lo = std::max(lo, t.max_value[len - 1] + 1);
+        const unsigned long long len_hi = std::min(hi, t.max_value[len]);
+
+        // A number with smallest period d also has every multiple of d as a period, so
+        // with_period(p) counts it once for each divisor p of len that d divides. Peel those
+        // off by inclusion-exclusion to get totals by smallest period, then keep the smallest
+        // periods that extend to some accepted repeat count.
+        std::array<QueryResult, MAX_LEN + 1> by_smallest_period{};
+        for (int d = 1; d <= len; ++d) {
+            if (len % d != 0) continue;
+
+            QueryResult exact = with_period(t, len_lo, len_hi, len, d);
+            for (int e = 1; e < d; ++e) {
+                if (d % e == 0) {
+                    exact.count -= by_smallest_period[e].count;
+                    exact.sum -= by_smallest_period[e].sum;
+                }
+            }
+            by_smallest_period[d] = exact;
+
+            bool accepted = false;
+            for (int p = d; p <= len && !accepted; p += d) {
+                const int repeats = len / p;
+                accepted = len % p == 0 && repeats >= min_repeats && repeats <= max_repeats;
+            }
+            if (accepted) {
+                total.count += exact.count;
+                total.sum += exact.sum;
+            }
         }
-        if (is_repeated_pattern(i)) {
-            sum_of_repeated_pattern += i;
+    }
+
+    return total;
+}
+
+template <unsigned BASE>
+QueryResult query_pattern_range(unsigned long long lo, unsigned long long hi, int min_repeats,
+                                int max_repeats) {
+    return query_pattern_range(POWER_TABLE<BASE>, lo, hi, min_repeats, max_repeats);
+}
+
+// Entry point for arbitrary queries; the common bases get their own instantiation.
+QueryResult query_pattern(const Range& r, unsigned base, int min_repeats, int max_repeats) {
+    if (base < 2 || base > 36) {
+        throw std::invalid_argument("Base must be between 2 and 36");
+    }
+    if (min_repeats < 1 || max_repeats < min_repeats) {
+        throw std::invalid_argument("Invalid repeat bounds");
+    }
+    if (r.end < r.start || r.end < 1) return {0, 0};
+
+    const auto lo = static_cast<unsigned long long>(std::max(r.start, 1LL));
+    const auto hi = static_cast<unsigned long long>(r.end);
+
+    switch (base) {
+        case 2:
+            return query_pattern_range<2>(lo, hi, min_repeats, max_repeats);
+        case 8:
+            return query_pattern_range<8>(lo, hi, min_repeats, max_repeats);
+        case 10:
+            return query_pattern_range<10>(lo, hi, min_repeats, max_repeats);
+        case 16:
+            return query_pattern_range<16>(lo, hi, min_repeats, max_repeats);
+        default:
+            return query_pattern_range(make_power_table(base), lo, hi, min_repeats, max_repeats);
+    }
+}
+
+std::tuple<long long, long long> sum_range_closed_form(const Range& r) {
+    if (r.end < r.start || r.end < 1) return {0, 0};
+
+    const auto lo = static_cast<unsigned long long>(std::max(r.start, 1LL));
+    const auto hi = static_cast<unsigned long long>(r.end);
+
+    return {query_pattern_range<10>(lo, hi, 2, 2).sum,
+            query_pattern_range<10>(lo, hi, 2, UNBOUNDED_REPEATS).sum};
+}
+
+// --- Batch mode ---
+
+// F(x): both sums over [1, x]. Any range then costs F(end) - F(start - 1).
+std::tuple<long long, long long> prefix_sums(long long x) {
+    if (x < 1) return {0, 0};
+    return sum_range_closed_form({1, x});
+}
+
+std::tuple<long long, long long> range_sums(const Range& r) {
+    if (r.end < r.start) return {0, 0};
+    auto [end_p1, end_p2] = prefix_sums(r.end);
+    auto [before_p1, before_p2] = prefix_sums(r.start - 1);
+    return {static_cast<unsigned long long>(end_p1) - static_cast<unsigned long long>(before_p1),
+            static_cast<unsigned long long>(end_p2) - static_cast<unsigned long long>(before_p2)};
+}
+
+// Sorts the ranges and joins overlapping or touching ones, so every number is counted once.
+std::vector<Range> merge_ranges(std::vector<Range> ranges) {
+    std::erase_if(ranges, [](const Range& r) { return r.end < r.start; });
+    if (ranges.empty()) return ranges;
+
+    std::sort(std::execution::par, ranges.begin(), ranges.end(),
+              [](const Range& a, const Range& b) { return a.start < b.start; });
+
+    std::vector<Range> merged;
+    merged.push_back(ranges[0]);
+    for (size_t i = 1; i < ranges.size(); ++i) {
+        Range& last = merged.back();
+        if (ranges[i].start <= last.end || ranges[i].start - 1 == last.end) {
+            last.end = std::max(last.end, ranges[i].end);
+        } else {
+            merged.push_back(ranges[i]);
         }
     }
+    return merged;
+}
 
-    return {sum_of_double_repeated, sum_of_repeated_pattern};
+std::vector<std::tuple<long long, long long>> per_range_sums(const std::vector<Range>& ranges) {
+    std::vector<std::tuple<long long, long long>> sums(ranges.size());
+    std::transform(std::execution::par, ranges.begin(), ranges.end(), sums.begin(), range_sums);
+    return sums;
+}
+
+std::tuple<unsigned long long, unsigned long long> union_sums(const std::vector<Range>& ranges) {
+    const auto merged = merge_ranges(ranges);
+    return std::transform_reduce(
+        std::execution::par, merged.begin(), merged.end(),
+        std::tuple<unsigned long long, unsigned long long>{0, 0},
+        [](const auto& a, const auto& b) {
+            return std::tuple<unsigned long long, unsigned long long>{
+                std::get<0>(a) + std::get<0>(b), std::get<1>(a) + std::get<1>(b)};
+        },
+        [](const Range& r) {
+            auto [p1, p2] = range_sums(r);
+            return std::tuple<unsigned long long, unsigned long long>{p1, p2};
+        });
 }
 
 int main(int argc, char* argv[]) {
     try {
         const auto start = std::chrono::high_resolution_clock::now();
 
-        std::string filename = (argc > 1) ? argv[1] : "input.txt";
+        std::string filename = "input.txt";
+        bool brute_force = false;
+        bool union_mode = false;
+        bool per_range = false;
+        std::optional<std::tuple<unsigned, int, int>> query;
+        for (int i = 1; i < argc; ++i) {
+            const std::string_view arg = argv[i];
+            if (arg == "--brute") {
+                brute_force = true;
+            } else if (arg == "--union") {
+                union_mode = true;
+            } else if (arg == "--per-range") {
+                per_range = true;
+            } else if (arg == "--query" && i + 3 < argc) {
+                // --query <base> <min_repeats> <max_repeats>, max_repeats 0 means unbounded
+                unsigned base = std::stoul(argv[i + 1]);
+                int min_repeats = std::stoi(argv[i + 2]);
+                int max_repeats = std::stoi(argv[i + 3]);
+                if (max_repeats == 0) max_repeats = UNBOUNDED_REPEATS;
+                query = {base, min_repeats, max_repeats};
+                i += 3;
+            } else {
+                filename = argv[i];
+            }
+        }
 
         const std::string content = read_content(filename);
         const auto ranges = parse_file(content);
 
+        if (per_range) {
+            const auto sums = per_range_sums(ranges);
+            for (size_t i = 0; i < ranges.size(); ++i) {
+                std::println("{}-{}: {} {}", ranges[i].start, ranges[i].end, std::get<0>(sums[i]),
+                             std::get<1>(sums[i]));
+            }
+        }
+
+        if (union_mode) {
+            auto [union_p1, union_p2] = union_sums(ranges);
+            std::println("union_p1: {}", union_p1);
+            std::println("union_p2: {}", union_p2);
+        }
+
+        if (query) {
+            auto [base, min_repeats, max_repeats] = *query;
+            QueryResult total{0, 0};
+            for (const auto& r : ranges) {
+                auto result = query_pattern(r, base, min_repeats, max_repeats);
+                total.count += result.count;
+                total.sum += result.sum;
+            }
+            std::println("query count: {}", total.count);
+            std::println("query sum: {}", total.sum);
+        }
+
         unsigned long long answer_p1 = 0;
         unsigned long long answer_p2 = 0;
         for (const auto& r : ranges) {
-            auto [x, y] = loop_range_elements(r);
+            auto [x, y] = brute_force ? loop_range_elements(r) : sum_range_closed_form(r);
             answer_p1 += x;
             answer_p2 += y;
         }
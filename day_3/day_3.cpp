@@ -1,71 +1,350 @@
+#include <algorithm>
+#include <array>
 #include <chrono>
 #include <cstddef>
+#include <cstdint>
+#include <execution>
+#include <expected>
 #include <filesystem>
 #include <iostream>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <vector>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "mapped_file.h"
 #include "utils.h"
 
-int64_t calculate_max_bank_joltage(std::string_view bank, size_t k) {
-    if (bank.length() < k) {
-        throw std::runtime_error("Bank length is smaller than required selection count");
+enum class BankError {
+    TooShort,
+    NonDigit,
+};
+
+// One pass over the bank, 16 bytes at a time where SSE2 is available.
+bool is_all_digits(std::string_view bank) {
+    const char* ptr = bank.data();
+    const char* end = ptr + bank.size();
+
+#if defined(__SSE2__)
+    const __m128i zero_char = _mm_set1_epi8('0');
+    const __m128i nine = _mm_set1_epi8(9);
+    __m128i bad = _mm_setzero_si128();
+
+    for (; end - ptr >= 16; ptr += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));
+        // c - '0' as unsigned bytes is <= 9 only for digits; anything larger sets bits here.
+        __m128i offset = _mm_sub_epi8(chunk, zero_char);
+        bad = _mm_or_si128(bad, _mm_subs_epu8(offset, nine));
     }
 
-    std::string result;
-    result.reserve(bank.length());
-    size_t to_drop = bank.length() - k;
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(bad, _mm_setzero_si128())) != 0xFFFF) return false;
+#endif
+
+    unsigned char bad_tail = 0;
+    for (; ptr < end; ++ptr) {
+        bad_tail |= static_cast<unsigned char>(*ptr - '0') > 9;
+    }
+    return bad_tail == 0;
+}
+
+// Largest K-digit number that keeps the bank's digit order. The monotonic stack never holds
+// more than K digits, so it lives in a fixed array and the result is built arithmetically.
+template <size_t K>
+std::expected<int64_t, BankError> max_bank_joltage(std::string_view bank) {
+    static_assert(K > 0 && K <= 18, "K digits must fit in int64_t");
 
-    for (char digit : bank) {
-        if (!isdigit(digit)) {
-            throw std::invalid_argument("Bank contains non-digit characters");
+    if (bank.length() < K) return std::unexpected(BankError::TooShort);
+    if (!is_all_digits(bank)) return std::unexpected(BankError::NonDigit);
+
+    std::array<char, K> stack;
+    size_t top = 0;
+    const size_t n = bank.length();
+
+    for (size_t i = 0; i < n; ++i) {
+        const char digit = bank[i];
+        // Pop only while the remaining digits can still refill the stack to K.
+        while (top > 0 && stack[top - 1] < digit && top - 1 + (n - i) >= K) {
+            top--;
         }
+        if (top < K) {
+            stack[top++] = digit;
+        }
+    }
+
+    int64_t value = 0;
+    for (char digit : stack) {
+        value = value * 10 + (digit - '0');
+    }
+    return value;
+}
+
+// --- All k in one traversal ---
 
-        while (to_drop > 0 && !result.empty() && result.back() < digit) {
-            result.pop_back();
-            to_drop--;
+constexpr size_t MAX_ALL_K = 18;
+
+// A single k = 18 selection fits in int64_t, but sums of them over many banks do not.
+__extension__ typedef unsigned __int128 JoltageTotal;
+
+std::string to_string(JoltageTotal value) {
+    std::string digits;
+    do {
+        digits += static_cast<char>('0' + static_cast<int>(value % 10));
+        value /= 10;
+    } while (value != 0);
+    std::reverse(digits.begin(), digits.end());
+    return digits;
+}
+
+// next_digit[i][d]: first position >= i holding digit d, or n if there is none.
+using NextDigitTable = std::vector<std::array<uint32_t, 10>>;
+
+void build_next_digit_table(std::string_view bank, NextDigitTable& next_digit) {
+    const auto n = static_cast<uint32_t>(bank.length());
+    next_digit.resize(bank.length() + 1);
+    next_digit[n].fill(n);
+    for (uint32_t i = n; i-- > 0;) {
+        next_digit[i] = next_digit[i + 1];
+        next_digit[i][bank[i] - '0'] = i;
+    }
+}
+
+// Adds the best k-digit selection of `bank` to totals[k - 1] for every k up to totals.size().
+// After one backward pass each chosen digit costs at most 10 table lookups, so the bank costs
+// O(n + sum of k) instead of one full greedy scan per k.
+void accumulate_all_k(std::string_view bank, std::vector<JoltageTotal>& totals,
+                      NextDigitTable& next_digit) {
+    if (!is_all_digits(bank)) return;
+    build_next_digit_table(bank, next_digit);
+
+    const size_t n = bank.length();
+    for (size_t k = 1; k <= totals.size() && k <= n; ++k) {
+        int64_t value = 0;
+        size_t pos = 0;
+        for (size_t chosen = 0; chosen < k; ++chosen) {
+            // The digit must leave k - chosen - 1 digits after it.
+            const size_t last_allowed = n - (k - chosen);
+            for (int digit = 9; digit >= 0; --digit) {
+                const size_t at = next_digit[pos][digit];
+                if (at <= last_allowed) {
+                    value = value * 10 + digit;
+                    pos = at + 1;
+                    break;
+                }
+            }
         }
-        result.push_back(digit);
+        totals[k - 1] += static_cast<JoltageTotal>(value);
+    }
+}
+
+// --- Parallel chunked processing ---
+//
+// Banks are independent, so the mapped input is cut into newline-aligned chunks. Every chunk
+// accumulates its own `width` totals and the partial vectors are summed at the end.
+
+template <typename BankFn>
+std::vector<JoltageTotal> sum_banks_parallel(std::string_view data, size_t width,
+                                             BankFn per_bank) {
+    const size_t workers = std::max(1u, std::thread::hardware_concurrency());
+    const auto chunks = aoc::split_at_lines(data, workers * 4);
+
+    return std::transform_reduce(
+        std::execution::par, chunks.begin(), chunks.end(), std::vector<JoltageTotal>(width, 0),
+        [](std::vector<JoltageTotal> a, const std::vector<JoltageTotal>& b) {
+            for (size_t i = 0; i < a.size(); ++i) a[i] += b[i];
+            return a;
+        },
+        [&](std::string_view chunk) {
+            std::vector<JoltageTotal> totals(width, 0);
+            aoc::for_each_line(chunk, [&](std::string_view bank) { per_bank(bank, totals); });
+            return totals;
+        });
+}
+
+std::vector<JoltageTotal> all_k_totals(std::string_view data, size_t max_k) {
+    if (max_k == 0 || max_k > MAX_ALL_K) {
+        throw std::invalid_argument("k must be between 1 and 18");
     }
 
-    result.resize(k);
-    return std::stoll(result);
+    return sum_banks_parallel(data, max_k,
+                              [](std::string_view bank, std::vector<JoltageTotal>& totals) {
+                                  thread_local NextDigitTable next_digit;
+                                  accumulate_all_k(bank, totals, next_digit);
+                              });
 }
 
-void part_one_sol(const std::vector<std::string>& banks) {
-    int64_t total = 0;
-    for (const auto& bank : banks) {
-        try {
-            total += calculate_max_bank_joltage(bank, 2);
-        } catch (...) {
-            continue;
+// --- Huge k on very long banks ---
+//
+// The digit chosen at step j is the largest one in [pos, n - k + j]. Both window ends only move
+// right, so with the positions of each digit bucketed in order, one forward-only cursor per
+// digit finds it in at most 10 probes. Memory is one uint32_t per bank digit, and the result is
+// handed to a sink digit by digit instead of being held in an integer.
+
+class DigitPositions {
+   public:
+    explicit DigitPositions(std::string_view bank) : positions(bank.length()) {
+        std::array<uint32_t, 10> counts{};
+        for (char c : bank) counts[c - '0']++;
+        for (int d = 0; d < 10; ++d) offsets[d + 1] = offsets[d] + counts[d];
+
+        std::array<uint32_t, 10> fill{};
+        for (uint32_t i = 0; i < bank.length(); ++i) {
+            const int d = bank[i] - '0';
+            positions[offsets[d] + fill[d]++] = i;
+        }
+    }
+
+    // Largest digit with a position in [pos, last_allowed]; sets `at` to that position.
+    int largest_in(size_t pos, size_t last_allowed, size_t& at) {
+        for (int d = 9; d >= 0; --d) {
+            uint32_t& cursor = cursors[d];
+            const uint32_t bucket_end = offsets[d + 1] - offsets[d];
+            while (cursor < bucket_end && positions[offsets[d] + cursor] < pos) cursor++;
+            if (cursor < bucket_end && positions[offsets[d] + cursor] <= last_allowed) {
+                at = positions[offsets[d] + cursor];
+                return d;
+            }
         }
+        return -1;
+    }
+
+   private:
+    std::vector<uint32_t> positions;
+    std::array<uint32_t, 11> offsets{};
+    std::array<uint32_t, 10> cursors{};
+};
+
+template <typename DigitSink>
+std::expected<void, BankError> select_max_digits(std::string_view bank, size_t k,
+                                                 DigitSink&& sink) {
+    if (bank.length() < k) return std::unexpected(BankError::TooShort);
+    if (!is_all_digits(bank)) return std::unexpected(BankError::NonDigit);
+
+    DigitPositions digits(bank);
+    const size_t n = bank.length();
+    size_t pos = 0;
+    for (size_t chosen = 0; chosen < k; ++chosen) {
+        size_t at = 0;
+        sink(digits.largest_in(pos, n - (k - chosen), at));
+        pos = at + 1;
     }
-    std::println("Part 1 Total Output: {}", total);
+    return {};
 }
 
-void part_two_sol(const std::vector<std::string>& banks) {
-    int64_t total = 0;
-    for (const auto& bank : banks) {
-        try {
-            total += calculate_max_bank_joltage(bank, 12);
-        } catch (...) {
-            continue;
+// Writes the selected digits as one decimal line through a fixed buffer.
+class DecimalSink {
+   public:
+    explicit DecimalSink(std::ostream& out) : out(out) {}
+    ~DecimalSink() {
+        flush();
+    }
+
+    void operator()(int digit) {
+        buffer[used++] = static_cast<char>('0' + digit);
+        if (used == buffer.size()) flush();
+    }
+
+    void flush() {
+        out.write(buffer.data(), static_cast<std::streamsize>(used));
+        used = 0;
+    }
+
+   private:
+    std::ostream& out;
+    std::array<char, 64 * 1024> buffer;
+    size_t used = 0;
+};
+
+constexpr uint64_t MAX_MODULUS = 1ULL << 60;
+
+// Horner reduction of the selected number modulo `modulus`; below 2^60, r * 10 + 9 cannot
+// overflow.
+struct ModuloSink {
+    uint64_t modulus;
+    uint64_t residue = 0;
+
+    void operator()(int digit) {
+        residue = (residue * 10 + static_cast<uint64_t>(digit)) % modulus;
+    }
+};
+
+void huge_k_sol(std::string_view data, size_t k, uint64_t modulus) {
+    if (modulus >= MAX_MODULUS) {
+        throw std::invalid_argument("Modulus must be below 2^60");
+    }
+
+    uint64_t total = 0;
+    aoc::for_each_line(data, [&](std::string_view bank) {
+        if (modulus == 0) {
+            std::expected<void, BankError> status;
+            {
+                DecimalSink sink(std::cout);
+                status = select_max_digits(bank, k, sink);
+            }
+            if (status) std::cout << '\n';
+            return;
         }
+
+        ModuloSink sink{modulus};
+        if (select_max_digits(bank, k, sink)) {
+            std::println("{}", sink.residue);
+            total = (total + sink.residue) % modulus;
+        }
+    });
+
+    if (modulus != 0) {
+        std::println("Total mod {}: {}", modulus, total);
     }
-    std::println("Part 2 Total Output: {}", total);
+}
+
+void parts_sol(std::string_view data) {
+    const auto totals =
+        sum_banks_parallel(data, 2, [](std::string_view bank, std::vector<JoltageTotal>& totals) {
+            totals[0] += static_cast<JoltageTotal>(max_bank_joltage<2>(bank).value_or(0));
+            totals[1] += static_cast<JoltageTotal>(max_bank_joltage<12>(bank).value_or(0));
+        });
+    std::println("Part 1 Total Output: {}", to_string(totals[0]));
+    std::println("Part 2 Total Output: {}", to_string(totals[1]));
 }
 
 int main(int argc, char* argv[]) {
     try {
         const auto start = std::chrono::high_resolution_clock::now();
 
-        std::string filename = (argc > 1) ? argv[1] : "input.txt";
-        const auto& data = aoc::read_lines(filename, "day_3");
+        std::string filename = "input.txt";
+        size_t all_k = 0;
+        size_t huge_k = 0;
+        uint64_t modulus = 0;
+        for (int i = 1; i < argc; ++i) {
+            const std::string_view arg = argv[i];
+            if (arg == "--all-k" && i + 1 < argc) {
+                all_k = std::stoul(argv[++i]);
+            } else if (arg == "--huge-k" && i + 1 < argc) {
+                huge_k = std::stoull(argv[++i]);
+            } else if (arg == "--mod" && i + 1 < argc) {
+                modulus = std::stoull(argv[++i]);
+            } else {
+                filename = argv[i];
+            }
+        }
+
+        const aoc::MappedFile file(aoc::resolve_file(filename, "day_3"));
+        const std::string_view data = file.view();
 
-        part_one_sol(data);
-        part_two_sol(data);
+        if (huge_k > 0) {
+            huge_k_sol(data, huge_k, modulus);
+        } else if (all_k > 0) {
+            const auto totals = all_k_totals(data, all_k);
+            for (size_t k = 1; k <= totals.size(); ++k) {
+                std::println("k = {}: {}", k, to_string(totals[k - 1]));
+            }
+        } else {
+            parts_sol(data);
+        }
 
         const auto end = std::chrono::high_resolution_clock::now();
         const auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
@@ -1,97 +1,903 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <barrier>
+#include <bit>
 #include <chrono>
+#include <condition_variable>
 #include <cstddef>
+#include <cstdint>
+#include <deque>
 #include <iostream>
+#include <mutex>
+#include <ranges>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <utility>
 #include <vector>
 
+#include "mapped_file.h"
 #include "utils.h"
 
-auto part_1_logic(const std::vector<std::string>& data) -> int {
-    const std::vector<std::pair<int, int>> directions{{-1, -1}, {-1, 0}, {-1, 1}, {0, -1},
-                                                      {0, 1},   {1, -1}, {1, 0},  {1, 1}};
-    auto answer = 0;
+// Largest row or column offset a stencil may use.
+constexpr int MAX_RADIUS = 2;
 
-    for (size_t i = 0; i < data.size(); ++i) {
-        for (size_t j = 0; j < data[i].size(); ++j) {
-            if (data[i][j] == '.') {
-                continue;
+// Grid stored as bit-rows: bit c of word c / 64 is set when column c holds a roll. Every row
+// has a zero word on each side and there are MAX_RADIUS zero rows above and below, so the
+// neighbours of any word can be read without bounds checks.
+class BitGrid {
+   public:
+    // Builds the grid straight from the raw file contents, one line at a time, so no
+    // per-line strings are ever held: a sizing pass, then a pass that sets the bits.
+    explicit BitGrid(std::string_view data) {
+        aoc::for_each_line(data, [&](std::string_view line) {
+            cols = std::max(cols, line.size());
+            rows++;
+        });
+        init_layout();
+        owned.assign(storage_words(rows, cols), 0);
+        bits = owned.data();
+
+        size_t i = 0;
+        aoc::for_each_line(data, [&](std::string_view line) { set_row(i++, line); });
+    }
+
+    // Grid over caller-provided, zero-filled storage of storage_words(rows, cols) words.
+    BitGrid(size_t rows, size_t cols, uint64_t* storage) : rows(rows), cols(cols), bits(storage) {
+        init_layout();
+    }
+
+    BitGrid(const BitGrid&) = delete;
+    BitGrid& operator=(const BitGrid&) = delete;
+    BitGrid(BitGrid&&) = default;
+
+    static size_t storage_words(size_t rows, size_t cols) {
+        return (rows + 2 * MAX_RADIUS) * (cols / 64 + 3);
+    }
+
+    void set_row(size_t i, std::string_view line) {
+        uint64_t* row_bits = row(i);
+        for (size_t j = 0; j < line.size(); ++j) {
+            if (line[j] == '@') row_bits[j / 64] |= 1ULL << (j % 64);
+        }
+    }
+
+    // First real word of row i; rows -MAX_RADIUS..-1 and rows..rows+MAX_RADIUS-1 are padding.
+    uint64_t* row(size_t i) {
+        return bits + (i + MAX_RADIUS) * stride + 1;
+    }
+    const uint64_t* row(size_t i) const {
+        return bits + (i + MAX_RADIUS) * stride + 1;
+    }
+
+    size_t rows = 0;
+    size_t cols = 0;
+    size_t words = 0;
+    size_t stride = 0;
+
+   private:
+    void init_layout() {
+        words = cols / 64 + 1;
+        stride = words + 2;
+    }
+
+    std::vector<uint64_t> owned;
+    uint64_t* bits = nullptr;
+};
+
+// Bit c of the result holds cell c - 1 (the west neighbour of c).
+inline uint64_t west_of(const uint64_t* word) {
+    return (word[0] << 1) | (word[-1] >> 63);
+}
+
+// Bit c of the result holds cell c + 1 (the east neighbour of c).
+inline uint64_t east_of(const uint64_t* word) {
+    return (word[0] >> 1) | (word[1] << 63);
+}
+
+// Bit-sliced counter: adds one bit per lane into the 4-bit counts held in s0..s3.
+inline void add_plane(uint64_t x, uint64_t& s0, uint64_t& s1, uint64_t& s2, uint64_t& s3) {
+    uint64_t carry = s0 & x;
+    s0 ^= x;
+    uint64_t carry2 = s1 & carry;
+    s1 ^= carry;
+    s3 |= s2 & carry2;
+    s2 ^= carry2;
+}
+
+// Rolls in *mid with fewer than 4 of their 8 neighbours set, 64 cells at a time. Each pointer
+// addresses the centre word of a row; the words before and after it must be readable.
+inline uint64_t fewer_than_4(const uint64_t* up, const uint64_t* mid, const uint64_t* down) {
+    uint64_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    add_plane(west_of(up), s0, s1, s2, s3);
+    add_plane(up[0], s0, s1, s2, s3);
+    add_plane(east_of(up), s0, s1, s2, s3);
+    add_plane(west_of(mid), s0, s1, s2, s3);
+    add_plane(east_of(mid), s0, s1, s2, s3);
+    add_plane(west_of(down), s0, s1, s2, s3);
+    add_plane(down[0], s0, s1, s2, s3);
+    add_plane(east_of(down), s0, s1, s2, s3);
+
+    // count < 4 exactly when the 4s and 8s bits are both clear.
+    return mid[0] & ~(s2 | s3);
+}
+
+inline uint64_t accessible_mask(const BitGrid& grid, size_t i, size_t w) {
+    return fewer_than_4(grid.row(i - 1) + w, grid.row(i) + w, grid.row(i + 1) + w);
+}
+
+// --- Stencils ---
+//
+// A stencil is the set of (row, column) offsets counted as neighbours; a roll is accessible
+// when fewer than `threshold` of them hold rolls. Known stencils are template parameters so
+// every one gets an unrolled bit-sliced kernel, with the default 8-neighbour / 4 case mapped
+// to the hand-tuned fewer_than_4. Anything else goes through GenericKernel.
+
+struct Offset {
+    int dr;
+    int dc;
+};
+
+template <size_t N>
+struct Stencil {
+    std::array<Offset, N> offsets;
+};
+
+inline constexpr Stencil<8> MOORE{
+    {{{-1, -1}, {-1, 0}, {-1, 1}, {0, -1}, {0, 1}, {1, -1}, {1, 0}, {1, 1}}}};
+
+inline constexpr Stencil<4> VON_NEUMANN{{{{-1, 0}, {0, -1}, {0, 1}, {1, 0}}}};
+
+inline constexpr Stencil<24> MOORE_RADIUS_2 = [] {
+    Stencil<24> stencil{};
+    size_t k = 0;
+    for (int dr = -2; dr <= 2; ++dr) {
+        for (int dc = -2; dc <= 2; ++dc) {
+            if (dr != 0 || dc != 0) stencil.offsets[k++] = {dr, dc};
+        }
+    }
+    return stencil;
+}();
+
+constexpr int DEFAULT_THRESHOLD = 4;
+
+// Bit c of the result holds cell c + dc of the addressed row.
+template <int DC>
+inline uint64_t shifted(const uint64_t* word) {
+    if constexpr (DC == 0) {
+        return word[0];
+    } else if constexpr (DC < 0) {
+        return (word[0] << -DC) | (word[-1] >> (64 + DC));
+    } else {
+        return (word[0] >> DC) | (word[1] << (64 - DC));
+    }
+}
+
+inline uint64_t shifted(const uint64_t* word, int dc) {
+    if (dc == 0) return word[0];
+    if (dc < 0) return (word[0] << -dc) | (word[-1] >> (64 + dc));
+    return (word[0] >> dc) | (word[1] << (64 - dc));
+}
+
+// BITS-wide bit-sliced counters for 64 lanes.
+template <int BITS>
+struct SlicedCounter {
+    std::array<uint64_t, BITS> s{};
+
+    void add(uint64_t x) {
+        for (int b = 0; b < BITS; ++b) {
+            const uint64_t carry = s[b] & x;
+            s[b] ^= x;
+            x = carry;
+        }
+    }
+
+    // Lanes whose count is below `threshold`, comparing from the most significant bit down.
+    uint64_t less_than(int threshold) const {
+        if (threshold >= (1 << BITS)) return ~0ULL;
+        uint64_t lt = 0;
+        uint64_t eq = ~0ULL;
+        for (int b = BITS - 1; b >= 0; --b) {
+            const uint64_t t = ((threshold >> b) & 1) ? ~0ULL : 0;
+            lt |= eq & ~s[b] & t;
+            eq &= ~(s[b] ^ t);
+        }
+        return lt;
+    }
+};
+
+template <const auto& STENCIL, int THRESHOLD = -1>
+struct StencilKernel {
+    static constexpr int BITS = std::bit_width(STENCIL.offsets.size());
+
+    int threshold = THRESHOLD;
+
+    uint64_t operator()(const BitGrid& grid, size_t i, size_t w) const {
+        if constexpr (static_cast<const void*>(&STENCIL) == &MOORE &&
+                      THRESHOLD == DEFAULT_THRESHOLD) {
+            return accessible_mask(grid, i, w);
+        } else {
+            SlicedCounter<BITS> counter;
+            [&]<size_t... K>(std::index_sequence<K...>) {
+                (counter.add(shifted<STENCIL.offsets[K].dc>(grid.row(i + STENCIL.offsets[K].dr) +
+                                                              w)),
+                 ...);
+            }(std::make_index_sequence<STENCIL.offsets.size()>{});
+            return grid.row(i)[w] & counter.less_than(threshold);
+        }
+    }
+};
+
+struct GenericKernel {
+    std::vector<Offset> offsets;
+    int threshold;
+
+    uint64_t operator()(const BitGrid& grid, size_t i, size_t w) const {
+        SlicedCounter<5> counter;
+        for (const auto& [dr, dc] : offsets) counter.add(shifted(grid.row(i + dr) + w, dc));
+        return grid.row(i)[w] & counter.less_than(threshold);
+    }
+};
+
+struct StencilSpec {
+    enum class Kind { Moore, VonNeumann, MooreRadius2, Custom } kind = Kind::Moore;
+    std::vector<Offset> offsets{MOORE.offsets.begin(), MOORE.offsets.end()};
+    int threshold = DEFAULT_THRESHOLD;
+};
+
+// Parses "moore", "von-neumann", "radius-2" or a square mask such as "010,101,010" whose
+// centre cell is ignored.
+StencilSpec parse_stencil(std::string_view text) {
+    auto from = [](StencilSpec::Kind kind, const auto& stencil) {
+        StencilSpec spec;
+        spec.kind = kind;
+        spec.offsets.assign(stencil.offsets.begin(), stencil.offsets.end());
+        return spec;
+    };
+
+    if (text == "moore") return from(StencilSpec::Kind::Moore, MOORE);
+    if (text == "von-neumann") return from(StencilSpec::Kind::VonNeumann, VON_NEUMANN);
+    if (text == "radius-2") return from(StencilSpec::Kind::MooreRadius2, MOORE_RADIUS_2);
+
+    std::vector<std::string_view> mask_rows;
+    for (auto part : text | std::views::split(',')) {
+        mask_rows.emplace_back(part.begin(), part.end());
+    }
+
+    const auto size = static_cast<int>(mask_rows.size());
+    const int radius = size / 2;
+    if (size % 2 == 0 || radius > MAX_RADIUS) {
+        throw std::invalid_argument("Stencil mask must be 1x1, 3x3 or 5x5");
+    }
+
+    StencilSpec spec;
+    spec.kind = StencilSpec::Kind::Custom;
+    spec.offsets.clear();
+    for (int r = 0; r < size; ++r) {
+        if (std::ssize(mask_rows[r]) != size) {
+            throw std::invalid_argument("Stencil mask must be square");
+        }
+        for (int c = 0; c < size; ++c) {
+            if (mask_rows[r][c] == '1' && (r != radius || c != radius)) {
+                spec.offsets.push_back({r - radius, c - radius});
+            }
+        }
+    }
+    return spec;
+}
+
+// Calls fn(kernel) with the most specialised kernel for `spec`, so the loops inside fn are
+// instantiated once per kernel rather than calling through a pointer for every word.
+template <typename Fn>
+decltype(auto) with_kernel(const StencilSpec& spec, Fn&& fn) {
+    switch (spec.kind) {
+        case StencilSpec::Kind::Moore:
+            if (spec.threshold == DEFAULT_THRESHOLD) {
+                return fn(StencilKernel<MOORE, DEFAULT_THRESHOLD>{});
+            }
+            return fn(StencilKernel<MOORE>{spec.threshold});
+        case StencilSpec::Kind::VonNeumann:
+            return fn(StencilKernel<VON_NEUMANN>{spec.threshold});
+        case StencilSpec::Kind::MooreRadius2:
+            return fn(StencilKernel<MOORE_RADIUS_2>{spec.threshold});
+        default:
+            return fn(GenericKernel{spec.offsets, spec.threshold});
+    }
+}
+
+template <typename Kernel>
+auto part_1_logic(const BitGrid& grid, const Kernel& kernel) -> long long {
+    long long answer = 0;
+
+    for (size_t i = 0; i < grid.rows; ++i) {
+        for (size_t w = 0; w < grid.words; ++w) {
+            answer += std::popcount(kernel(grid, i, w));
+        }
+    }
+
+    return answer;
+}
+
+// One removal round: every accessible roll is removed at once. `removed` is scratch space
+// reused across rounds.
+template <typename Kernel>
+auto part_2_logic(BitGrid& grid, std::vector<uint64_t>& removed, const Kernel& kernel)
+    -> long long {
+    long long answer = 0;
+    removed.resize(grid.rows * grid.words);
+
+    for (size_t i = 0; i < grid.rows; ++i) {
+        for (size_t w = 0; w < grid.words; ++w) {
+            const uint64_t mask = kernel(grid, i, w);
+            removed[i * grid.words + w] = mask;
+            answer += std::popcount(mask);
+        }
+    }
+
+    for (size_t i = 0; i < grid.rows; ++i) {
+        uint64_t* row_bits = grid.row(i);
+        for (size_t w = 0; w < grid.words; ++w) {
+            row_bits[w] &= ~removed[i * grid.words + w];
+        }
+    }
+
+    return answer;
+}
+
+struct PeelResult {
+    long long total;
+    std::vector<long long> per_round;
+};
+
+// Removes rolls until none is accessible, touching every cell a constant number of times.
+// Neighbour counts are computed once; a removal decrements its neighbours, and those that
+// drop below the threshold form the next round. Because a roll joins round k + 1 exactly when
+// its count after rounds 1..k falls below the threshold, the rounds match the simultaneous
+// rescans of part_2_logic.
+PeelResult peel_rolls(const BitGrid& grid, const StencilSpec& spec) {
+    // Counts and states live on a grid with a MAX_RADIUS border, so no bounds checks are needed.
+    const size_t stride = grid.cols + 2 * MAX_RADIUS;
+    std::vector<ptrdiff_t> neighbours;
+    for (const auto& [dr, dc] : spec.offsets) {
+        neighbours.push_back(dr * static_cast<ptrdiff_t>(stride) + dc);
+    }
+    const int threshold = spec.threshold;
+
+    enum : uint8_t { EMPTY, ROLL, QUEUED };
+    std::vector<uint8_t> state((grid.rows + 2 * MAX_RADIUS) * stride, EMPTY);
+    std::vector<uint8_t> count(state.size(), 0);
+
+    for (size_t i = 0; i < grid.rows; ++i) {
+        const uint64_t* row_bits = grid.row(i);
+        for (size_t j = 0; j < grid.cols; ++j) {
+            if ((row_bits[j / 64] >> (j % 64)) & 1) {
+                state[(i + MAX_RADIUS) * stride + j + MAX_RADIUS] = ROLL;
+            }
+        }
+    }
+
+    std::vector<size_t> frontier;
+    for (size_t cell = MAX_RADIUS * stride; cell < state.size() - MAX_RADIUS * stride; ++cell) {
+        if (state[cell] == EMPTY) continue;
+        int n = 0;
+        for (auto offset : neighbours) n += state[cell + offset] != EMPTY;
+        count[cell] = static_cast<uint8_t>(n);
+        if (n < threshold) {
+            state[cell] = QUEUED;
+            frontier.push_back(cell);
+        }
+    }
+
+    PeelResult result{0, {}};
+    std::vector<size_t> next;
+    while (!frontier.empty()) {
+        result.per_round.push_back(static_cast<long long>(frontier.size()));
+        result.total += static_cast<long long>(frontier.size());
+
+        // Removed and queued rolls never need their count again, so only live ROLLs decrement.
+        for (size_t cell : frontier) state[cell] = EMPTY;
+        for (size_t cell : frontier) {
+            for (auto offset : neighbours) {
+                const size_t neighbour = cell + offset;
+                if (state[neighbour] == ROLL && --count[neighbour] < threshold) {
+                    state[neighbour] = QUEUED;
+                    next.push_back(neighbour);
+                }
             }
+        }
+
+        frontier.swap(next);
+        next.clear();
+    }
+
+    return result;
+}
+
+// --- Tiled multi-threaded engine ---
+//
+// The grid is cut into tiles of TILE_ROWS x TILE_WORDS words (32 KiB of bits) spread over a
+// thread pool. Apart from the grid itself (one bit per cell) a tile only keeps its one-cell
+// halo and three row buffers, so memory stays close to one bit per cell.
+
+constexpr size_t TILE_ROWS = 256;
+constexpr size_t TILE_WORDS = 16;
 
-            auto rulo_counter = 0;
-            for (const auto& [dr, dc] : directions) {
-                int neigh_row_index = static_cast<int>(i) + dr;
-                int neigh_col_index = static_cast<int>(j) + dc;
+struct Tile {
+    size_t r0, r1;  // rows [r0, r1)
+    size_t w0, w1;  // words [w0, w1)
+};
 
-                if (neigh_row_index >= 0 && neigh_row_index < std::ssize(data) &&
-                    neigh_col_index >= 0 && neigh_col_index < std::ssize(data) &&
-                    data[neigh_row_index][neigh_col_index] == '@') {
-                    rulo_counter++;
+struct TileLayout {
+    std::vector<Tile> tiles;
+    size_t tile_rows = 0;
+    size_t tile_cols = 0;
+
+    // Indices of the up to 8 tiles touching `t`.
+    std::vector<size_t> neighbours(size_t t) const {
+        std::vector<size_t> result;
+        const auto tr = static_cast<ptrdiff_t>(t / tile_cols);
+        const auto tc = static_cast<ptrdiff_t>(t % tile_cols);
+        for (ptrdiff_t dr = -1; dr <= 1; ++dr) {
+            for (ptrdiff_t dc = -1; dc <= 1; ++dc) {
+                const ptrdiff_t r = tr + dr;
+                const ptrdiff_t c = tc + dc;
+                const bool inside = r >= 0 && c >= 0 && r < static_cast<ptrdiff_t>(tile_rows) &&
+                                    c < static_cast<ptrdiff_t>(tile_cols);
+                if ((dr != 0 || dc != 0) && inside) {
+                    result.push_back(static_cast<size_t>(r) * tile_cols + static_cast<size_t>(c));
                 }
             }
+        }
+        return result;
+    }
+};
+
+TileLayout make_tiles(const BitGrid& grid) {
+    TileLayout layout;
+    layout.tile_rows = (grid.rows + TILE_ROWS - 1) / TILE_ROWS;
+    layout.tile_cols = (grid.words + TILE_WORDS - 1) / TILE_WORDS;
+    for (size_t r0 = 0; r0 < grid.rows; r0 += TILE_ROWS) {
+        for (size_t w0 = 0; w0 < grid.words; w0 += TILE_WORDS) {
+            layout.tiles.push_back({r0, std::min(r0 + TILE_ROWS, grid.rows), w0,
+                                    std::min(w0 + TILE_WORDS, grid.words)});
+        }
+    }
+    return layout;
+}
+
+// The cells around a tile as they were at the start of a round. Rows are stored with one extra
+// word on each side, matching the BitGrid padding.
+struct TileHalo {
+    std::vector<uint64_t> top, bottom;
+    std::vector<uint64_t> left, right;
+
+    void capture(const BitGrid& grid, const Tile& tile) {
+        top.assign(grid.row(tile.r0 - 1) + tile.w0 - 1, grid.row(tile.r0 - 1) + tile.w1 + 1);
+        bottom.assign(grid.row(tile.r1) + tile.w0 - 1, grid.row(tile.r1) + tile.w1 + 1);
+        left.resize(tile.r1 - tile.r0);
+        right.resize(tile.r1 - tile.r0);
+        for (size_t i = tile.r0; i < tile.r1; ++i) {
+            left[i - tile.r0] = *(grid.row(i) + tile.w0 - 1);
+            right[i - tile.r0] = grid.row(i)[tile.w1];
+        }
+    }
+};
+
+// One synchronous round inside a tile, updating it in place. Rows are swept top to bottom with
+// the previous row's old values kept aside, so every cell sees the state from the round start.
+long long sweep_tile(BitGrid& grid, const Tile& tile, const TileHalo& halo,
+                     std::array<std::vector<uint64_t>, 3>& buffers) {
+    const size_t n = tile.w1 - tile.w0;
+    auto load_row = [&](size_t i, std::vector<uint64_t>& out) {
+        out.resize(n + 2);
+        out[0] = halo.left[i - tile.r0];
+        std::copy_n(grid.row(i) + tile.w0, n, out.begin() + 1);
+        out[n + 1] = halo.right[i - tile.r0];
+    };
+
+    auto& [prev, cur, next] = buffers;
+    prev = halo.top;
+    load_row(tile.r0, cur);
+
+    long long removed = 0;
+    for (size_t i = tile.r0; i < tile.r1; ++i) {
+        if (i + 1 < tile.r1) {
+            load_row(i + 1, next);
+        } else {
+            next = halo.bottom;
+        }
+
+        uint64_t* row_bits = grid.row(i) + tile.w0;
+        for (size_t k = 0; k < n; ++k) {
+            const uint64_t mask = fewer_than_4(&prev[k + 1], &cur[k + 1], &next[k + 1]);
+            row_bits[k] &= ~mask;
+            removed += std::popcount(mask);
+        }
+
+        std::swap(prev, cur);
+        std::swap(cur, next);
+    }
+    return removed;
+}
+
+// Same rounds as part_2_logic: halos are captured behind one barrier, tiles are swept behind a
+// second. Returns the removal count of every round.
+std::vector<long long> peel_tiled(BitGrid& grid, size_t thread_count) {
+    const auto layout = make_tiles(grid);
+    std::vector<TileHalo> halos(layout.tiles.size());
+    std::vector<long long> per_round;
+    std::atomic<long long> round_removed = 0;
+    bool sweep_phase = false;
+    bool done = layout.tiles.empty();
+
+    auto on_phase_end = [&]() noexcept {
+        if (sweep_phase) {
+            const long long removed = round_removed.exchange(0);
+            if (removed == 0) {
+                done = true;
+            } else {
+                per_round.push_back(removed);
+            }
+        }
+        sweep_phase = !sweep_phase;
+    };
+    std::barrier sync(static_cast<ptrdiff_t>(thread_count), on_phase_end);
 
-            if (rulo_counter < 4) {
-                answer++;
+    auto worker = [&](size_t id) {
+        std::array<std::vector<uint64_t>, 3> buffers;
+        while (!done) {
+            for (size_t t = id; t < layout.tiles.size(); t += thread_count) {
+                halos[t].capture(grid, layout.tiles[t]);
             }
+            sync.arrive_and_wait();
+
+            long long removed = 0;
+            for (size_t t = id; t < layout.tiles.size(); t += thread_count) {
+                removed += sweep_tile(grid, layout.tiles[t], halos[t], buffers);
+            }
+            round_removed += removed;
+            sync.arrive_and_wait();
         }
+    };
+
+    {
+        std::vector<std::jthread> pool;
+        for (size_t id = 0; id < thread_count; ++id) pool.emplace_back(worker, id);
     }
+    return per_round;
+}
 
-    return answer;
+// Asynchronous variant: a tile repeats its own sweeps until nothing more falls, updating in
+// place and reading its neighbours' current edges. Whenever it removes something its
+// neighbours are queued again. Removal only lowers counts, so any order reaches the same final
+// grid; only the round structure is lost.
+long long sweep_tile_async(BitGrid& grid, const Tile& tile) {
+    auto load = [](const uint64_t* word) {
+        return std::atomic_ref<uint64_t>(*const_cast<uint64_t*>(word))
+            .load(std::memory_order_relaxed);
+    };
+    auto load3 = [&](const uint64_t* word, std::array<uint64_t, 3>& out) {
+        out = {load(word - 1), load(word), load(word + 1)};
+    };
+
+    long long removed = 0;
+    std::array<uint64_t, 3> up, mid, down;
+    while (true) {
+        long long pass = 0;
+        for (size_t i = tile.r0; i < tile.r1; ++i) {
+            for (size_t w = tile.w0; w < tile.w1; ++w) {
+                load3(grid.row(i - 1) + w, up);
+                load3(grid.row(i) + w, mid);
+                load3(grid.row(i + 1) + w, down);
+
+                const uint64_t mask = fewer_than_4(&up[1], &mid[1], &down[1]);
+                if (mask != 0) {
+                    // Only this tile writes its own words.
+                    std::atomic_ref<uint64_t>(grid.row(i)[w])
+                        .store(mid[1] & ~mask, std::memory_order_relaxed);
+                    pass += std::popcount(mask);
+                }
+            }
+        }
+        if (pass == 0) break;
+        removed += pass;
+    }
+    return removed;
 }
 
-auto part_2_logic(std::vector<std::string>& data) -> int {
-    const std::vector<std::pair<int, int>> directions{{-1, -1}, {-1, 0}, {-1, 1}, {0, -1},
-                                                      {0, 1},   {1, -1}, {1, 0},  {1, 1}};
-    auto answer = 0;
-    std::vector<std::pair<int, int>> removed_indexes{};
+long long peel_tiled_async(BitGrid& grid, size_t thread_count) {
+    const auto layout = make_tiles(grid);
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<size_t> queue;
+    std::vector<char> queued(layout.tiles.size(), 1);
+    for (size_t t = 0; t < layout.tiles.size(); ++t) queue.push_back(t);
+    size_t active = 0;
+    std::atomic<long long> total = 0;
 
-    for (size_t i = 0; i < data.size(); ++i) {
-        for (size_t j = 0; j < data[i].size(); ++j) {
-            if (data[i][j] == '.') {
-                continue;
+    auto worker = [&]() {
+        std::unique_lock lock(mutex);
+        while (true) {
+            wake.wait(lock, [&] { return !queue.empty() || active == 0; });
+            if (queue.empty()) {
+                wake.notify_all();
+                return;
             }
 
-            auto rulo_counter = 0;
-            for (const auto& [dr, dc] : directions) {
-                int neigh_row_index = static_cast<int>(i) + dr;
-                int neigh_col_index = static_cast<int>(j) + dc;
+            const size_t t = queue.front();
+            queue.pop_front();
+            queued[t] = 0;
+            active++;
+            lock.unlock();
+
+            const long long removed = sweep_tile_async(grid, layout.tiles[t]);
+            total += removed;
 
-                if (neigh_row_index >= 0 && neigh_row_index < std::ssize(data) &&
-                    neigh_col_index >= 0 && neigh_col_index < std::ssize(data) &&
-                    data[neigh_row_index][neigh_col_index] == '@') {
-                    rulo_counter++;
+            lock.lock();
+            active--;
+            if (removed > 0) {
+                for (size_t n : layout.neighbours(t)) {
+                    if (!queued[n]) {
+                        queued[n] = 1;
+                        queue.push_back(n);
+                    }
                 }
             }
+            wake.notify_all();
+        }
+    };
+
+    {
+        std::vector<std::jthread> pool;
+        for (size_t id = 0; id < thread_count; ++id) pool.emplace_back(worker);
+    }
+    return total;
+}
+
+// --- Out-of-core engine ---
+//
+// For grids larger than RAM. Part 1 streams the file keeping three bit-rows. Part 2 keeps the
+// grid as bits in an unlinked, memory-mapped scratch file and peels it one band of rows at a
+// time, re-visiting a band whenever a neighbouring band removes rolls on their shared edge.
+// Only the default 8-neighbour, < 4 rule is supported here.
+
+constexpr size_t BAND_ROWS = 64;
+
+struct StreamedGrid {
+    long long part1 = 0;
+    size_t rows = 0;
+    size_t cols = 0;
+};
+
+// One pass over the file: part 1 plus the grid dimensions needed to size the scratch file.
+StreamedGrid stream_part_1(const fs::path& path) {
+    std::ifstream file(path);
+    if (!file) throw std::runtime_error("Unable to open file: " + path.string());
+
+    StreamedGrid result;
+    size_t words = 1;
+    // prev, cur and next bit-rows, each with a zero word on both sides.
+    std::array<std::vector<uint64_t>, 3> band;
+    for (auto& row : band) row.assign(words + 2, 0);
+    auto& [prev, cur, next] = band;
+
+    auto load = [&](const std::string& line, std::vector<uint64_t>& out) {
+        const size_t needed = line.size() / 64 + 1;
+        if (needed > words) {
+            words = needed;
+            for (auto& row : band) row.resize(words + 2, 0);
+        }
+        std::fill(out.begin(), out.end(), 0);
+        for (size_t j = 0; j < line.size(); ++j) {
+            if (line[j] == '@') out[j / 64 + 1] |= 1ULL << (j % 64);
+        }
+        result.cols = std::max(result.cols, line.size());
+    };
+
+    std::string line;
+    if (!std::getline(file, line)) return result;
+    load(line, cur);
+    result.rows = 1;
 
-            if (rulo_counter < 4) {
-                answer++;
-                removed_indexes.push_back({i, j});
+    bool more = true;
+    while (more) {
+        more = static_cast<bool>(std::getline(file, line));
+        if (more) {
+            load(line, next);
+            result.rows++;
+        } else {
+            std::fill(next.begin(), next.end(), 0);
+        }
+
+        for (size_t k = 1; k <= words; ++k) {
+            result.part1 += std::popcount(fewer_than_4(&prev[k], &cur[k], &next[k]));
+        }
+
+        std::swap(prev, cur);
+        std::swap(cur, next);
+    }
+
+    return result;
+}
+
+struct BandOutcome {
+    long long removed = 0;
+    bool top_changed = false;
+    bool bottom_changed = false;
+};
+
+// Peels rows [r0, r1) in place until stable. Row-level dirty flags limit each pass to rows
+// next to a recent removal. Also reports whether the first or last row lost a roll, which can
+// unlock the neighbouring band.
+BandOutcome peel_band(BitGrid& grid, size_t r0, size_t r1, std::vector<char>& dirty) {
+    BandOutcome outcome;
+    dirty.assign(r1 - r0, 1);
+
+    bool any = true;
+    while (any) {
+        any = false;
+        for (size_t i = r0; i < r1; ++i) {
+            if (!dirty[i - r0]) continue;
+            dirty[i - r0] = 0;
+
+            long long removed = 0;
+            uint64_t* row_bits = grid.row(i);
+            for (size_t w = 0; w < grid.words; ++w) {
+                const uint64_t mask = accessible_mask(grid, i, w);
+                row_bits[w] &= ~mask;
+                removed += std::popcount(mask);
             }
+            if (removed == 0) continue;
+
+            outcome.removed += removed;
+            outcome.top_changed |= i == r0;
+            outcome.bottom_changed |= i + 1 == r1;
+            for (size_t j = std::max(i, r0 + 1) - 1; j < std::min(i + 2, r1); ++j) {
+                dirty[j - r0] = 1;
+            }
+            any = true;
+        }
+    }
+    return outcome;
+}
+
+long long peel_out_of_core(BitGrid& grid) {
+    const size_t bands = (grid.rows + BAND_ROWS - 1) / BAND_ROWS;
+    std::vector<char> band_dirty(bands, 1);
+    std::vector<char> row_dirty;
+    long long total = 0;
+
+    bool any = true;
+    while (any) {
+        any = false;
+        for (size_t b = 0; b < bands; ++b) {
+            if (!band_dirty[b]) continue;
+            band_dirty[b] = 0;
+
+            const size_t r0 = b * BAND_ROWS;
+            const size_t r1 = std::min(r0 + BAND_ROWS, grid.rows);
+            const auto outcome = peel_band(grid, r0, r1, row_dirty);
+            total += outcome.removed;
+            if (outcome.top_changed && b > 0) band_dirty[b - 1] = 1;
+            if (outcome.bottom_changed && b + 1 < bands) band_dirty[b + 1] = 1;
+            any |= outcome.removed > 0;
         }
     }
+    return total;
+}
+
+void out_of_core_sol(const fs::path& path, const fs::path& scratch_dir) {
+    const auto streamed = stream_part_1(path);
+    std::println("Answer {} ", streamed.part1);
 
-    for (const auto& [i, j] : removed_indexes) {
-        data[i][j] = '.';
+    aoc::ScratchMapping scratch(scratch_dir,
+                                BitGrid::storage_words(streamed.rows, streamed.cols) * 8);
+    BitGrid grid(streamed.rows, streamed.cols, scratch.as<uint64_t>());
+
+    std::ifstream file(path);
+    std::string line;
+    for (size_t i = 0; i < streamed.rows && std::getline(file, line); ++i) {
+        grid.set_row(i, line);
     }
 
-    return answer;
+    std::println("Answer {} ", peel_out_of_core(grid));
 }
 
 int main(int argc, char* argv[]) {
     try {
         const auto start = std::chrono::high_resolution_clock::now();
 
-        std::string filename = (argc > 1) ? argv[1] : "input.txt";
-        auto grid = aoc::read_lines(filename, "day_4");
+        std::string filename = "input.txt";
+        bool print_rounds = false;
+        bool rescan_rounds = false;
+        bool tiled = false;
+        bool tiled_async = false;
+        size_t thread_count = std::max(1u, std::thread::hardware_concurrency());
+        StencilSpec spec;
+        int threshold = DEFAULT_THRESHOLD;
+        bool out_of_core = false;
+        fs::path scratch_dir = fs::temp_directory_path();
+        for (int i = 1; i < argc; ++i) {
+            const std::string_view arg = argv[i];
+            if (arg == "--rounds") {
+                print_rounds = true;
+            } else if (arg == "--rescan") {
+                rescan_rounds = true;
+            } else if (arg == "--tiled") {
+                tiled = true;
+            } else if (arg == "--tiled-async") {
+                tiled_async = true;
+            } else if (arg == "--out-of-core") {
+                out_of_core = true;
+            } else if (arg == "--scratch" && i + 1 < argc) {
+                scratch_dir = argv[++i];
+            } else if (arg == "--stencil" && i + 1 < argc) {
+                spec = parse_stencil(argv[++i]);
+            } else if (arg == "--threshold" && i + 1 < argc) {
+                threshold = std::stoi(argv[++i]);
+            } else if (arg == "--threads" && i + 1 < argc) {
+                thread_count = std::max<size_t>(1, std::stoul(argv[++i]));
+            } else {
+                filename = argv[i];
+            }
+        }
+
+        spec.threshold = threshold;
+        const bool default_stencil =
+            spec.kind == StencilSpec::Kind::Moore && spec.threshold == DEFAULT_THRESHOLD;
+        if ((tiled || tiled_async) && !default_stencil) {
+            throw std::invalid_argument("Tiled engines only support the 8-neighbour, < 4 rule");
+        }
+        if (out_of_core && !default_stencil) {
+            throw std::invalid_argument("Out-of-core mode only supports the 8-neighbour, < 4 rule");
+        }
 
-        auto answer = part_1_logic(grid);
+        if (out_of_core) {
+            out_of_core_sol(aoc::resolve_file(filename, "day_4"), scratch_dir);
 
-        auto answer_p2 = 0;
-        while (true) {
-            auto ret = part_2_logic(grid);
-            answer_p2 += ret;
-            if (ret == 0) {
-                break;
+            const auto end = std::chrono::high_resolution_clock::now();
+            const auto duration =
+                std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+            std::println("Total Time: {} µs", duration.count());
+            return 0;
+        }
+
+        const aoc::MappedFile file(aoc::resolve_file(filename, "day_4"));
+        BitGrid grid(file.view());
+
+        auto answer =
+            with_kernel(spec, [&](const auto& kernel) { return part_1_logic(grid, kernel); });
+
+        long long answer_p2 = 0;
+        std::vector<long long> rounds;
+        if (tiled_async) {
+            answer_p2 = peel_tiled_async(grid, thread_count);
+        } else if (tiled) {
+            rounds = peel_tiled(grid, thread_count);
+            for (long long removed : rounds) answer_p2 += removed;
+        } else if (rescan_rounds) {
+            with_kernel(spec, [&](const auto& kernel) {
+                std::vector<uint64_t> removed;
+                while (true) {
+                    auto ret = part_2_logic(grid, removed, kernel);
+                    answer_p2 += ret;
+                    if (ret == 0) {
+                        break;
+                    }
+                    rounds.push_back(ret);
+                }
+            });
+        } else {
+            auto peeled = peel_rolls(grid, spec);
+            answer_p2 = peeled.total;
+            rounds = std::move(peeled.per_round);
+        }
+
+        if (print_rounds) {
+            for (size_t r = 0; r < rounds.size(); ++r) {
+                std::println("Round {}: {}", r + 1, rounds[r]);
             }
         }
 
@@ -1,52 +1,515 @@
 #include <algorithm>
+#include <array>
+#include <bit>
 #include <chrono>
 #include <cstddef>
+#include <exception>
+#include <execution>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <span>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include "mapped_file.h"
 #include "utils.h"
 
 namespace fs = std::filesystem;
 
-void part_two_sol(std::vector<std::pair<unsigned long long, unsigned long long>> range_vec) {
-    std::sort(range_vec.begin(), range_vec.end());
+using IdRange = std::pair<unsigned long long, unsigned long long>;
 
-    unsigned long long answer_p2 = 0;
-    unsigned long long current_start = range_vec[0].first;
-    unsigned long long current_end = range_vec[0].second;
+// Sorted, disjoint ranges covering the same IDs as `range_vec`.
+std::vector<IdRange> merge_ranges(std::vector<IdRange> range_vec) {
+    std::sort(range_vec.begin(), range_vec.end());
 
-    for (size_t i = 1; i < range_vec.size(); ++i) {
-        if (range_vec[i].first <= current_end) {
-            current_end = std::max(current_end, range_vec[i].second);
+    std::vector<IdRange> merged;
+    for (const auto& range : range_vec) {
+        if (!merged.empty() && range.first <= merged.back().second) {
+            merged.back().second = std::max(merged.back().second, range.second);
         } else {
-            answer_p2 += (current_end - current_start + 1);
-            current_start = range_vec[i].first;
-            current_end = range_vec[i].second;
+            merged.push_back(range);
+        }
+    }
+    return merged;
+}
+
+// Parallel form of merge_ranges for very long range lists. After a parallel sort every chunk
+// is merged in place on its own; a short sequential pass then absorbs each chunk's leading
+// ranges into the previous output while they still overlap, and the survivors are copied out
+// in parallel at their final offsets.
+std::vector<IdRange> merge_ranges_parallel(std::vector<IdRange> range_vec) {
+    std::sort(std::execution::par, range_vec.begin(), range_vec.end());
+
+    const size_t parts = std::max<size_t>(1, std::thread::hardware_concurrency() * 4);
+    const size_t chunk_size = (range_vec.size() + parts - 1) / parts;
+
+    struct Chunk {
+        size_t begin = 0;
+        size_t end = 0;
+        size_t offset = 0;
+    };
+    std::vector<Chunk> chunks;
+    for (size_t base = 0; base < range_vec.size(); base += chunk_size) {
+        chunks.push_back({base, std::min(base + chunk_size, range_vec.size())});
+    }
+
+    std::for_each(std::execution::par, chunks.begin(), chunks.end(), [&](Chunk& chunk) {
+        size_t out = chunk.begin;
+        for (size_t i = chunk.begin + 1; i < chunk.end; ++i) {
+            if (range_vec[i].first <= range_vec[out].second) {
+                range_vec[out].second = std::max(range_vec[out].second, range_vec[i].second);
+            } else {
+                range_vec[++out] = range_vec[i];
+            }
         }
+        chunk.end = out + 1;
+    });
+
+    // Fix-up across chunk boundaries. A long range can swallow several chunks whole.
+    size_t total = 0;
+    IdRange* last = nullptr;
+    for (auto& chunk : chunks) {
+        while (last != nullptr && chunk.begin < chunk.end &&
+               range_vec[chunk.begin].first <= last->second) {
+            last->second = std::max(last->second, range_vec[chunk.begin].second);
+            ++chunk.begin;
+        }
+        chunk.offset = total;
+        total += chunk.end - chunk.begin;
+        if (chunk.begin < chunk.end) last = &range_vec[chunk.end - 1];
+    }
+
+    std::vector<IdRange> merged(total);
+    std::for_each(std::execution::par, chunks.begin(), chunks.end(), [&](const Chunk& chunk) {
+        std::copy(range_vec.begin() + chunk.begin, range_vec.begin() + chunk.end,
+                  merged.begin() + chunk.offset);
+    });
+    return merged;
+}
+
+// Range lists at least this long are merged with merge_ranges_parallel.
+constexpr size_t PARALLEL_MERGE_MIN = 1 << 16;
+
+std::vector<IdRange> union_ranges(std::vector<IdRange> range_vec) {
+    if (range_vec.size() >= PARALLEL_MERGE_MIN) {
+        return merge_ranges_parallel(std::move(range_vec));
     }
+    return merge_ranges(std::move(range_vec));
+}
 
-    answer_p2 += (current_end - current_start + 1);
+void part_two_sol(const std::vector<IdRange>& merged) {
+    unsigned long long answer_p2 = 0;
+    for (const auto& [start, end] : merged) {
+        answer_p2 += (end - start + 1);
+    }
 
     std::println("answer part 2: {}", answer_p2);
 }
 
-auto part_one_sol(const std::vector<unsigned long long>& ids,
-                  const std::vector<std::pair<unsigned long long, unsigned long long>>& range_vec) {
-    auto count = std::ranges::count_if(ids, [&](auto id) {
-        return std::ranges::any_of(
-            range_vec, [&](const auto& range) { return id >= range.first && id <= range.second; });
-    });
+// Membership index over merged ranges. The range ends are laid out in Eytzinger (BFS) order,
+// so a search walks down an implicit binary tree without branches and the next levels sit in
+// predictable cache lines that can be prefetched. A lookup finds the first range whose end is
+// >= id; id is covered when that range also starts at or before it.
+class RangeIndex {
+   public:
+    explicit RangeIndex(const std::vector<IdRange>& merged)
+        : size(merged.size()), ends(merged.size() + 1), starts(merged.size() + 1) {
+        size_t next = 0;
+        fill(merged, next, 1);
+
+        // Depth of the tree: every search runs exactly this many steps.
+        depth = std::bit_width(size);
+    }
+
+    // Number of `ids` covered by some range. Searches run in lock-step groups so the cache
+    // misses of independent lookups overlap instead of being paid one after another.
+    size_t count_contained(std::span<const unsigned long long> ids) const {
+        size_t count = 0;
+        std::array<size_t, BATCH> k;
+
+        for (size_t base = 0; base < ids.size(); base += BATCH) {
+            const size_t n = std::min(BATCH, ids.size() - base);
+            k.fill(1);
+
+            for (int level = 0; level < depth; ++level) {
+                for (size_t j = 0; j < n; ++j) {
+                    // Searches that already fell off a shorter branch of the tree stay put.
+                    const bool inside = k[j] <= size;
+                    const size_t node = inside ? k[j] : 0;
+                    __builtin_prefetch(ends.data() + std::min(node * PREFETCH_STRIDE, size));
+                    const size_t step = 2 * k[j] + (ends[node] < ids[base + j]);
+                    k[j] = inside ? step : k[j];
+                }
+            }
+            for (size_t j = 0; j < n; ++j) {
+                count += covered(k[j], ids[base + j]);
+            }
+        }
+        return count;
+    }
+
+   private:
+    static constexpr size_t BATCH = 32;
+    // Eight 8-byte keys per cache line: prefetch the descendants three levels down.
+    static constexpr size_t PREFETCH_STRIDE = 8;
+
+    void fill(const std::vector<IdRange>& merged, size_t& next, size_t k) {
+        if (k > size) return;
+        fill(merged, next, 2 * k);
+        starts[k] = merged[next].first;
+        ends[k] = merged[next].second;
+        next++;
+        fill(merged, next, 2 * k + 1);
+    }
+
+    // Undoes the final right turns to recover the node where the search last went left.
+    bool covered(size_t k, unsigned long long id) const {
+        k >>= std::countr_one(k) + 1;
+        return k != 0 && starts[k] <= id;
+    }
+
+    size_t size;
+    int depth = 0;
+    std::vector<unsigned long long> ends;
+    std::vector<unsigned long long> starts;
+};
+
+// --- Sorted sweep ---
+//
+// With very many IDs it is cheaper to sort them and merge against the ranges than to search
+// for each one. The sorted IDs are split into chunks that are swept in parallel; each chunk
+// finds its first range with one binary search.
+
+// LSD radix sort on 16-bit digits; passes where every key has the same digit are skipped.
+void radix_sort(std::vector<unsigned long long>& ids) {
+    constexpr int DIGIT_BITS = 16;
+    constexpr size_t BUCKETS = size_t{1} << DIGIT_BITS;
+
+    std::vector<unsigned long long> buffer(ids.size());
+    std::vector<size_t> offsets(BUCKETS);
+
+    for (int shift = 0; shift < 64; shift += DIGIT_BITS) {
+        std::fill(offsets.begin(), offsets.end(), 0);
+        for (auto id : ids) offsets[(id >> shift) & (BUCKETS - 1)]++;
+        if (ids.empty() || offsets[(ids[0] >> shift) & (BUCKETS - 1)] == ids.size()) continue;
+
+        size_t sum = 0;
+        for (auto& offset : offsets) {
+            const size_t count = offset;
+            offset = sum;
+            sum += count;
+        }
+        for (auto id : ids) buffer[offsets[(id >> shift) & (BUCKETS - 1)]++] = id;
+        ids.swap(buffer);
+    }
+}
+
+// How many of the four IDs at `ids` are >= start.
+inline size_t count_at_least_x4(const unsigned long long* ids, unsigned long long start) {
+#if defined(__AVX2__)
+    // AVX2 only compares signed 64-bit lanes; flipping the sign bit keeps unsigned order.
+    const __m256i sign = _mm256_set1_epi64x(static_cast<long long>(1ULL << 63));
+    const __m256i values =
+        _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(ids)), sign);
+    const __m256i bound = _mm256_xor_si256(_mm256_set1_epi64x(static_cast<long long>(start)), sign);
+    const int below = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(bound, values)));
+    return 4 - static_cast<size_t>(std::popcount(static_cast<unsigned>(below)));
+#else
+    return (ids[0] >= start) + (ids[1] >= start) + (ids[2] >= start) + (ids[3] >= start);
+#endif
+}
+
+// Two-pointer merge of sorted IDs against the merged ranges, from the first range that can
+// hold ids[0]. IDs are tested four at a time while the whole group stays inside the range.
+size_t sweep_count(std::span<const unsigned long long> ids, const std::vector<IdRange>& merged) {
+    if (ids.empty()) return 0;
+
+    auto r = static_cast<size_t>(
+        std::ranges::lower_bound(merged, ids[0], {}, &IdRange::second) - merged.begin());
+    size_t count = 0;
+    size_t j = 0;
+
+    for (; j < ids.size() && r < merged.size(); ++r) {
+        const auto [start, end] = merged[r];
+        for (; j + 4 <= ids.size() && ids[j + 3] <= end; j += 4) {
+            count += count_at_least_x4(&ids[j], start);
+        }
+        for (; j < ids.size() && ids[j] <= end; ++j) {
+            count += ids[j] >= start;
+        }
+    }
+    return count;
+}
+
+size_t sweep_count_parallel(const std::vector<unsigned long long>& sorted_ids,
+                            const std::vector<IdRange>& merged) {
+    constexpr size_t CHUNK = 1 << 20;
+
+    std::vector<std::span<const unsigned long long>> chunks;
+    for (size_t base = 0; base < sorted_ids.size(); base += CHUNK) {
+        chunks.emplace_back(sorted_ids.data() + base, std::min(CHUNK, sorted_ids.size() - base));
+    }
+
+    return std::transform_reduce(std::execution::par, chunks.begin(), chunks.end(), size_t{0},
+                                 std::plus<>(),
+                                 [&](auto chunk) { return sweep_count(chunk, merged); });
+}
+
+// --- Dynamic interval set ---
+//
+// Disjoint ranges keyed by start in an ordered map, for range lists that change while running.
+// The covered total is kept up to date by every insert and erase, so it never needs a rebuild.
+// An update touches O(log n) map nodes plus the ranges it merges or splits.
+
+class IntervalSet {
+   public:
+    void insert(unsigned long long start, unsigned long long end) {
+        if (start > end) return;
+
+        // Step back to a range that overlaps or touches `start`.
+        auto it = ranges.upper_bound(start);
+        if (it != ranges.begin() && touches(std::prev(it)->second, start)) --it;
+
+        while (it != ranges.end() && touches(end, it->first)) {
+            start = std::min(start, it->first);
+            end = std::max(end, it->second);
+            covered -= it->second - it->first + 1;
+            it = ranges.erase(it);
+        }
+
+        ranges.emplace_hint(it, start, end);
+        covered += end - start + 1;
+    }
+
+    void erase(unsigned long long start, unsigned long long end) {
+        if (start > end) return;
+
+        auto it = ranges.upper_bound(start);
+        if (it != ranges.begin() && std::prev(it)->second >= start) --it;
+
+        while (it != ranges.end() && it->first <= end) {
+            const auto [first, last] = *it;
+            covered -= last - first + 1;
+            it = ranges.erase(it);
+
+            if (first < start) {
+                ranges.emplace_hint(it, first, start - 1);
+                covered += start - first;
+            }
+            if (last > end) {
+                ranges.emplace_hint(it, end + 1, last);
+                covered += last - end;
+                break;
+            }
+        }
+    }
+
+    bool contains(unsigned long long id) const {
+        auto it = ranges.upper_bound(id);
+        return it != ranges.begin() && std::prev(it)->second >= id;
+    }
+
+    // IDs in [start, end] covered by some range.
+    unsigned long long covered_in(unsigned long long start, unsigned long long end) const {
+        if (start > end) return 0;
+
+        auto it = ranges.upper_bound(start);
+        if (it != ranges.begin() && std::prev(it)->second >= start) --it;
+
+        unsigned long long count = 0;
+        for (; it != ranges.end() && it->first <= end; ++it) {
+            count += std::min(end, it->second) - std::max(start, it->first) + 1;
+        }
+        return count;
+    }
+
+    unsigned long long total() const {
+        return covered;
+    }
+
+   private:
+    // True when a range ending at `end` overlaps or is adjacent to one starting at `start`.
+    static bool touches(unsigned long long end, unsigned long long start) {
+        return start <= end || start - 1 == end;
+    }
+
+    std::map<unsigned long long, unsigned long long> ranges;
+    unsigned long long covered = 0;
+};
+
+// Reads update and query commands from `in`, one per line:
+//   + a-b     insert a range        - a-b     erase a range
+//   ? id      point membership      # a-b     covered IDs in [a, b]
+//   =         covered total
+void live_sol(IntervalSet& set, std::istream& in) {
+    auto parse_range = [](std::string_view text) -> IdRange {
+        const auto pivot = text.find('-');
+        if (pivot == std::string_view::npos) throw std::invalid_argument("Expected a-b range");
+        return {std::stoull(std::string(text.substr(0, pivot))),
+                std::stoull(std::string(text.substr(pivot + 1)))};
+    };
+
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty()) continue;
+        const std::string_view args =
+            std::string_view(line).substr(std::min<size_t>(2, line.size()));
+
+        switch (line[0]) {
+            case '+': {
+                auto [a, b] = parse_range(args);
+                set.insert(a, b);
+                break;
+            }
+            case '-': {
+                auto [a, b] = parse_range(args);
+                set.erase(a, b);
+                break;
+            }
+            case '?':
+                std::println("{}",
+                             set.contains(std::stoull(std::string(args))) ? "fresh" : "spoiled");
+                break;
+            case '#': {
+                auto [a, b] = parse_range(args);
+                std::println("{}", set.covered_in(a, b));
+                break;
+            }
+            case '=':
+                std::println("{}", set.total());
+                break;
+            default:
+                std::cerr << "Unknown command: " << line << "\n";
+        }
+    }
+}
+
+auto part_one_sol(const std::vector<unsigned long long>& ids, const RangeIndex& index) {
+    auto count = index.count_contained(ids);
 
     std::println("answer part 1: {}", count);
 }
 
+// --- Streaming classification ---
+//
+// Works straight on the mapped file: only the ranges are kept, while IDs are parsed into a
+// fixed buffer and classified a batch at a time, so memory is bounded by the range count.
+
+// Parses the unsigned decimal at `p` and leaves `p` on the first non-digit. Throws like
+// std::stoull when there is no digit or the value does not fit in 64 bits.
+unsigned long long parse_u64(const char*& p, const char* end) {
+    if (p == end || static_cast<unsigned char>(*p - '0') >= 10) {
+        throw std::invalid_argument("Expected a number");
+    }
+
+    unsigned long long value = 0;
+    while (p < end && static_cast<unsigned char>(*p - '0') < 10) {
+        if (__builtin_mul_overflow(value, 10ULL, &value) ||
+            __builtin_add_overflow(value, static_cast<unsigned>(*p - '0'), &value)) {
+            throw std::out_of_range("ID does not fit in 64 bits");
+        }
+        ++p;
+    }
+    return value;
+}
+
+// Parses the range section up to the blank line; `tail` receives the ID section after it.
+std::vector<IdRange> parse_ranges(std::string_view data, std::string_view& tail) {
+    std::vector<IdRange> ranges;
+    while (!data.empty()) {
+        const size_t newline = data.find('\n');
+        std::string_view line = data.substr(0, newline);
+        data.remove_prefix(newline == std::string_view::npos ? data.size() : newline + 1);
+
+        if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+        if (line.empty()) break;
+
+        const char* p = line.data();
+        const char* end = p + line.size();
+        const auto first = parse_u64(p, end);
+        if (p == end || *p != '-') {
+            throw std::runtime_error("Malformed range: " + std::string(line));
+        }
+        ++p;
+        const auto last = parse_u64(p, end);
+        if (last < first) throw std::runtime_error("Malformed range: " + std::string(line));
+        ranges.emplace_back(first, last);
+    }
+    tail = data;
+    return ranges;
+}
+
+// Number of IDs in `tail` covered by `index`.
+size_t classify_stream(std::string_view tail, const RangeIndex& index) {
+    constexpr size_t BATCH = 4096;
+    std::array<unsigned long long, BATCH> ids;
+    size_t pending = 0;
+    size_t count = 0;
+
+    const char* p = tail.data();
+    const char* end = p + tail.size();
+    while (p < end) {
+        if (static_cast<unsigned char>(*p - '0') >= 10) {
+            ++p;
+            continue;
+        }
+        ids[pending++] = parse_u64(p, end);
+        if (pending == BATCH) {
+            count += index.count_contained({ids.data(), pending});
+            pending = 0;
+        }
+    }
+    return count + index.count_contained({ids.data(), pending});
+}
+
+size_t classify_stream_parallel(std::string_view tail, const RangeIndex& index) {
+    const auto chunks = aoc::split_at_lines(tail, std::thread::hardware_concurrency() * 4);
+
+    // An exception escaping a parallel algorithm calls std::terminate, so a parse error is
+    // carried out of the workers and rethrown here.
+    std::exception_ptr failure;
+    std::mutex failure_mutex;
+    const size_t count = std::transform_reduce(
+        std::execution::par, chunks.begin(), chunks.end(), size_t{0}, std::plus<>(),
+        [&](std::string_view chunk) -> size_t {
+            try {
+                return classify_stream(chunk, index);
+            } catch (...) {
+                const std::lock_guard lock(failure_mutex);
+                if (!failure) failure = std::current_exception();
+                return 0;
+            }
+        });
+    if (failure) std::rethrow_exception(failure);
+    return count;
+}
+
+void stream_sol(const fs::path& path) {
+    const aoc::MappedFile file(path);
+
+    std::string_view tail;
+    const auto merged = union_ranges(parse_ranges(file.view(), tail));
+    const RangeIndex range_index(merged);
+
+    std::println("answer part 1: {}", classify_stream_parallel(tail, range_index));
+    part_two_sol(merged);
+}
+
 auto get_range_vec(const std::vector<std::string>& data, int index) {
-    std::vector<std::pair<unsigned long long, unsigned long long>> vec{};
+    std::vector<IdRange> vec{};
 
     for (size_t i = 0; i < static_cast<size_t>(index); i++) {
         std::string copy_line = data[i];
@@ -54,9 +517,9 @@ auto get_range_vec(const std::vector<std::string>& data, int index) {
         auto pos = copy_line.find('-');
 
         if (pos != std::string::npos) {
-            auto first_part = stoul(copy_line.substr(0, pos));
+            auto first_part = stoull(copy_line.substr(0, pos));
             copy_line.erase(0, pos + 1);
-            auto second_part = stoul(copy_line);
+            auto second_part = stoull(copy_line);
             vec.push_back({first_part, second_part});
         }
     }
@@ -67,7 +530,7 @@ auto get_range_vec(const std::vector<std::string>& data, int index) {
 auto get_ids(const std::vector<std::string>& data, int index) {
     std::vector<unsigned long long> vec{};
     for (size_t i = index + 1; i < data.size(); i++) {
-        vec.push_back(stoul(data[i]));
+        vec.push_back(stoull(data[i]));
     }
 
     return vec;
@@ -112,14 +575,53 @@ int main(int argc, char* argv[]) {
     try {
         const auto start = std::chrono::high_resolution_clock::now();
 
-        std::string filename = (argc > 1) ? argv[1] : "input.txt";
+        std::string filename = "input.txt";
+        bool sweep = false;
+        bool live = false;
+        bool stream = false;
+        for (int i = 1; i < argc; ++i) {
+            if (std::string_view(argv[i]) == "--sweep") {
+                sweep = true;
+            } else if (std::string_view(argv[i]) == "--live") {
+                live = true;
+            } else if (std::string_view(argv[i]) == "--stream") {
+                stream = true;
+            } else {
+                filename = argv[i];
+            }
+        }
+
+        if (stream) {
+            stream_sol(aoc::resolve_file(filename, "day_5"));
+            const auto end = std::chrono::high_resolution_clock::now();
+            const auto duration =
+                std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+            std::println("Total Time: {} µs", duration.count());
+            return 0;
+        }
+
         const auto& [data, index] = read_lines(filename);
 
-        const auto& id_vec = get_ids(data, index);
+        auto id_vec = get_ids(data, index);
         auto rvec = get_range_vec(data, index);
 
-        part_one_sol(id_vec, rvec);
-        part_two_sol(rvec);
+        if (live) {
+            IntervalSet set;
+            for (const auto& [a, b] : rvec) set.insert(a, b);
+            live_sol(set, std::cin);
+            return 0;
+        }
+
+        const auto merged = union_ranges(std::move(rvec));
+
+        if (sweep) {
+            radix_sort(id_vec);
+            std::println("answer part 1: {}", sweep_count_parallel(id_vec, merged));
+        } else {
+            const RangeIndex range_index(merged);
+            part_one_sol(id_vec, range_index);
+        }
+        part_two_sol(merged);
         const auto end = std::chrono::high_resolution_clock::now();
         const auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
 
@@ -1,154 +1,510 @@
 #include <algorithm>
+#include <bit>
+#include <cctype>
 #include <chrono>
 #include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <execution>
 #include <filesystem>
+#include <functional>
 #include <iostream>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <span>
+#include <stdexcept>
 #include <string>
+#include <string_view>
 #include <vector>
 
+#include "mapped_file.h"
 #include "utils.h"
 
-auto get_kth_string(const std::string& str, int K) {
-    std::stringstream iss(str);
-    std::string kth;
+// Unsigned integer of any size, as little-endian 32-bit limbs (empty for zero).
+class BigUint {
+   public:
+    explicit BigUint(uint64_t value = 0) {
+        for (; value != 0; value >>= 32) limbs.push_back(static_cast<uint32_t>(value));
+    }
+
+    BigUint& operator+=(const BigUint& other) {
+        if (other.limbs.size() > limbs.size()) limbs.resize(other.limbs.size(), 0);
 
-    while (iss >> kth && K) {
-        K--;
-        if (K == 0) {
-            break;
+        uint64_t carry = 0;
+        for (size_t i = 0; i < limbs.size() && (i < other.limbs.size() || carry != 0); ++i) {
+            const uint64_t sum = limbs[i] + carry + (i < other.limbs.size() ? other.limbs[i] : 0);
+            limbs[i] = static_cast<uint32_t>(sum);
+            carry = sum >> 32;
         }
+        if (carry != 0) limbs.push_back(static_cast<uint32_t>(carry));
+        return *this;
     }
 
-    return kth;
-}
+    BigUint& operator*=(uint64_t factor) {
+        const auto high = static_cast<uint32_t>(factor >> 32);
+        if (high == 0) {
+            multiply_limb(static_cast<uint32_t>(factor));
+            return *this;
+        }
+
+        // x * factor = x * low + ((x * high) << 32)
+        BigUint shifted = *this;
+        shifted.multiply_limb(high);
+        if (!shifted.limbs.empty()) shifted.limbs.insert(shifted.limbs.begin(), 0);
+        multiply_limb(static_cast<uint32_t>(factor));
+        return *this += shifted;
+    }
+
+    std::string to_string() const {
+        if (limbs.empty()) return "0";
+
+        // Peel off base-10^9 chunks, least significant first.
+        std::vector<uint32_t> rest = limbs;
+        std::vector<uint32_t> chunks;
+        while (!rest.empty()) {
+            uint64_t remainder = 0;
+            for (size_t i = rest.size(); i-- > 0;) {
+                const uint64_t current = (remainder << 32) | rest[i];
+                rest[i] = static_cast<uint32_t>(current / 1'000'000'000);
+                remainder = current % 1'000'000'000;
+            }
+            while (!rest.empty() && rest.back() == 0) rest.pop_back();
+            chunks.push_back(static_cast<uint32_t>(remainder));
+        }
+
+        std::string text = std::to_string(chunks.back());
+        for (size_t i = chunks.size() - 1; i-- > 0;) {
+            const std::string part = std::to_string(chunks[i]);
+            text.append(9 - part.size(), '0');
+            text += part;
+        }
+        return text;
+    }
 
-auto get_math_symbols(const std::string& str) {
-    std::stringstream ss(str);
-    std::string symbol;
-    std::vector<std::string> symbols;
+   private:
+    void multiply_limb(uint32_t factor) {
+        if (factor == 0) {
+            limbs.clear();
+            return;
+        }
+        uint64_t carry = 0;
+        for (auto& limb : limbs) {
+            const uint64_t product = static_cast<uint64_t>(limb) * factor + carry;
+            limb = static_cast<uint32_t>(product);
+            carry = product >> 32;
+        }
+        if (carry != 0) limbs.push_back(static_cast<uint32_t>(carry));
+    }
+
+    std::vector<uint32_t> limbs;
+};
+
+// Exact unsigned value that stays a native uint64_t until an add or multiply overflows, and only
+// then continues as a BigUint.
+class Wide {
+   public:
+    explicit Wide(uint64_t value = 0) : small(value) {}
+
+    Wide& operator+=(uint64_t value) {
+        uint64_t sum;
+        if (!big && !__builtin_add_overflow(small, value, &sum)) {
+            small = sum;
+            return *this;
+        }
+        promote();
+        *big += BigUint(value);
+        return *this;
+    }
+
+    Wide& operator+=(const Wide& other) {
+        if (!other.big) return *this += other.small;
+        promote();
+        *big += *other.big;
+        return *this;
+    }
 
-    while (ss >> symbol) {
-        symbols.push_back(symbol);
+    Wide& operator*=(uint64_t value) {
+        uint64_t product;
+        if (!big && !__builtin_mul_overflow(small, value, &product)) {
+            small = product;
+            return *this;
+        }
+        promote();
+        *big *= value;
+        return *this;
     }
 
-    return symbols;
+    std::string to_string() const {
+        return big ? big->to_string() : std::to_string(small);
+    }
+
+   private:
+    void promote() {
+        if (!big) big = BigUint(small);
+    }
+
+    uint64_t small;
+    std::optional<BigUint> big;
+};
+
+Wide add_wide(Wide total, const Wide& value) {
+    return total += value;
+}
+
+// value * 10 + digit. Throws like std::stoull when an operand does not fit in 64 bits.
+uint64_t append_digit(uint64_t value, unsigned digit) {
+    if (__builtin_mul_overflow(value, uint64_t{10}, &value) ||
+        __builtin_add_overflow(value, uint64_t{digit}, &value)) {
+        throw std::out_of_range("Operand does not fit in 64 bits");
+    }
+    return value;
 }
 
-auto part_one_sol(const std::vector<std::string>& data, std::vector<std::string> symbols) {
-    unsigned long long answer = 0;
+// The worksheet numbers in column-major order: problem `c` owns values[c * rows, (c + 1) * rows),
+// so every problem is one contiguous run of memory.
+struct Worksheet {
+    size_t rows = 0;
+    size_t columns = 0;
+    std::vector<uint64_t> values;
+    std::vector<char> ops;
+
+    std::span<const uint64_t> column(size_t c) const {
+        return {values.data() + c * rows, rows};
+    }
+};
+
+// Walks every line once, reading whitespace-separated numbers straight into the matrix.
+Worksheet tokenize(const std::vector<std::string>& data) {
+    Worksheet sheet;
+    for (char ch : data.back()) {
+        if (ch == '+' || ch == '*') {
+            sheet.ops.push_back(ch);
+        } else if (!std::isspace(static_cast<unsigned char>(ch))) {
+            throw std::runtime_error(std::string("Unknown operator: ") + ch);
+        }
+    }
+
+    sheet.rows = data.size() - 1;
+    sheet.columns = sheet.ops.size();
+    sheet.values.resize(sheet.rows * sheet.columns);
 
-    for (size_t i = 0; i < symbols.size(); i++) {
-        unsigned long long x = 1;
-        unsigned long long y = 0;
+    for (size_t r = 0; r < sheet.rows; ++r) {
+        const std::string& line = data[r];
+        size_t c = 0;
+        size_t i = 0;
 
-        for (size_t j = 0; j < data.size() - 1; j++) {
-            if (symbols[i] == "*") {
-                x *= std::stoul(get_kth_string(data[j], i + 1));
+        while (i < line.size()) {
+            if (!std::isdigit(static_cast<unsigned char>(line[i]))) {
+                ++i;
+                continue;
             }
-            if (symbols[i] == "+") {
-                y += std::stoul(get_kth_string(data[j], i + 1));
+            uint64_t value = 0;
+            while (i < line.size() && std::isdigit(static_cast<unsigned char>(line[i]))) {
+                value = append_digit(value, static_cast<unsigned>(line[i] - '0'));
+                ++i;
             }
+            if (c == sheet.columns) {
+                throw std::runtime_error("Row " + std::to_string(r) +
+                                         " has more numbers than operators");
+            }
+            sheet.values[c++ * sheet.rows + r] = value;
         }
 
-        if (symbols[i] == "*") {
-            answer += x;
+        if (c != sheet.columns) {
+            throw std::runtime_error("Row " + std::to_string(r) +
+                                     " has fewer numbers than operators");
         }
-        if (symbols[i] == "+") {
-            answer += y;
+    }
+
+    return sheet;
+}
+
+// Reduces a column with vectorized native math when a cheap bound proves it cannot overflow:
+// a product fits when the operands' bit widths add up to at most 64, and a sum fits when the
+// largest operand leaves room for `rows` additions. Otherwise falls back to exact Wide math.
+Wide solve_column(std::span<const uint64_t> column, char op) {
+    if (op == '*') {
+        const int bits = std::transform_reduce(
+            std::execution::unseq, column.begin(), column.end(), 0, std::plus<>(),
+            [](uint64_t value) { return static_cast<int>(std::bit_width(value)); });
+        if (bits <= 64) {
+            return Wide(std::reduce(std::execution::unseq, column.begin(), column.end(),
+                                    uint64_t{1}, std::multiplies<>()));
         }
+        Wide product(1);
+        for (uint64_t value : column) product *= value;
+        return product;
     }
 
-    std::println("answer: {}", answer);
+    const uint64_t largest =
+        std::reduce(std::execution::unseq, column.begin(), column.end(), uint64_t{0},
+                    [](uint64_t a, uint64_t b) { return std::max(a, b); });
+    if (std::bit_width(largest) + std::bit_width(column.size()) <= 64) {
+        return Wide(std::reduce(std::execution::unseq, column.begin(), column.end(), uint64_t{0}));
+    }
+    Wide sum;
+    for (uint64_t value : column) sum += value;
+    return sum;
+}
+
+auto part_one_sol(const Worksheet& sheet) {
+    std::vector<size_t> columns(sheet.columns);
+    std::iota(columns.begin(), columns.end(), size_t{0});
+
+    const Wide answer = std::transform_reduce(
+        std::execution::par, columns.begin(), columns.end(), Wide(), add_wide,
+        [&](size_t c) { return solve_column(sheet.column(c), sheet.ops[c]); });
+
+    std::println("answer: {}", answer.to_string());
 
     return answer;
 }
 
-auto part_two_sol(const std::vector<std::string>& data, const std::vector<std::string>&) {
-    if (data.empty()) return 0ULL;
+// The worksheet characters stored column by column, padded with spaces to the widest line:
+// column `c` (operator row last) is cells[c * rows, (c + 1) * rows).
+struct ColumnGrid {
+    size_t rows = 0;
+    size_t width = 0;
+    std::vector<char> cells;
 
-    size_t max_width = 0;
+    std::string_view column(size_t c) const {
+        return {cells.data() + c * rows, rows};
+    }
+};
+
+// Transposes the lines tile by tile, so both the reads and the scattered writes of a tile stay
+// within a few cache lines.
+ColumnGrid transpose(const std::vector<std::string>& data) {
+    constexpr size_t TILE = 32;
+
+    ColumnGrid grid;
+    grid.rows = data.size();
     for (const auto& line : data) {
-        max_width = std::max(max_width, line.size());
+        grid.width = std::max(grid.width, line.size());
+    }
+    grid.cells.assign(grid.rows * grid.width, ' ');
+
+    for (size_t r0 = 0; r0 < grid.rows; r0 += TILE) {
+        const size_t r1 = std::min(r0 + TILE, grid.rows);
+        for (size_t c0 = 0; c0 < grid.width; c0 += TILE) {
+            for (size_t r = r0; r < r1; ++r) {
+                const std::string& line = data[r];
+                const size_t c1 = std::min(c0 + TILE, line.size());
+                for (size_t c = c0; c < c1; ++c) {
+                    grid.cells[c * grid.rows + r] = line[c];
+                }
+            }
+        }
     }
-    size_t rows = data.size();
 
-    unsigned long long grand_total = 0;
-    std::vector<int> current_block_cols;
+    return grid;
+}
 
-    auto process_block = [&](const std::vector<int>& cols) {
-        if (cols.empty()) return;
+// A problem spans grid columns [begin, end).
+struct Block {
+    size_t begin = 0;
+    size_t end = 0;
+};
+
+std::vector<Block> find_blocks(const ColumnGrid& grid) {
+    std::vector<Block> blocks;
+    size_t begin = 0;
+    for (size_t c = 0; c <= grid.width; ++c) {
+        if (c == grid.width || grid.column(c).find_first_not_of(' ') == std::string_view::npos) {
+            if (begin < c) blocks.push_back({begin, c});
+            begin = c + 1;
+        }
+    }
+    return blocks;
+}
 
-        char op = ' ';
-        const std::string& op_row = data.back();
-        for (int c : cols) {
-            if (static_cast<size_t>(c) < op_row.size() && op_row[c] != ' ') {
-                op = op_row[c];
-                break;
+// Problems are read right to left; each column holds one number, top digit first.
+Wide solve_block(const ColumnGrid& grid, Block block) {
+    char op = ' ';
+    for (size_t c = block.end; c-- > block.begin && op == ' ';) op = grid.column(c).back();
+
+    std::optional<Wide> result;
+    for (size_t c = block.end; c-- > block.begin;) {
+        uint64_t value = 0;
+        bool has_digits = false;
+        for (char ch : grid.column(c).substr(0, grid.rows - 1)) {
+            const auto digit = static_cast<unsigned char>(ch - '0');
+            if (digit < 10) {
+                value = append_digit(value, digit);
+                has_digits = true;
             }
         }
+        if (!has_digits) continue;
+
+        if (!result) {
+            result.emplace(value);
+        } else if (op == '+') {
+            *result += value;
+        } else if (op == '*') {
+            *result *= value;
+        }
+    }
+    return result.value_or(Wide());
+}
 
-        std::vector<unsigned long long> numbers;
-
-        for (int c : cols) {
-            std::string num_str;
-            for (size_t r = 0; r < rows - 1; ++r) {
-                if (static_cast<size_t>(c) < data[r].size() && std::isdigit(data[r][c])) {
-                    num_str += data[r][c];
-                }
+auto part_two_sol(const ColumnGrid& grid) {
+    const auto blocks = find_blocks(grid);
+
+    // An exception escaping a parallel algorithm calls std::terminate, so an operand overflow
+    // is carried out of the workers and rethrown here.
+    std::exception_ptr failure;
+    std::mutex failure_mutex;
+    const Wide grand_total = std::transform_reduce(
+        std::execution::par, blocks.begin(), blocks.end(), Wide(), add_wide, [&](Block block) {
+            try {
+                return solve_block(grid, block);
+            } catch (...) {
+                const std::lock_guard lock(failure_mutex);
+                if (!failure) failure = std::current_exception();
+                return Wide();
             }
-            if (!num_str.empty()) {
-                numbers.push_back(std::stoull(num_str));
+        });
+    if (failure) std::rethrow_exception(failure);
+
+    std::println("answer part 2: {}", grand_total.to_string());
+
+    return grand_total;
+}
+
+// --- Streaming vertical slabs ---
+//
+// For worksheets millions of columns wide: the file stays mapped and one cursor per row moves
+// across it in lockstep. Each problem is solved for both parts as soon as its separator column
+// is reached, so nothing beyond the current block is ever materialized.
+
+class SlabCursor {
+   public:
+    explicit SlabCursor(std::string_view data) {
+        aoc::for_each_line(data, [&](std::string_view line) {
+            if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+            lines.push_back(line);
+        });
+        while (!lines.empty() && lines.back().empty()) lines.pop_back();
+        if (lines.size() < 2) throw std::runtime_error("Worksheet needs numbers and operators");
+
+        for (auto line : lines) width = std::max(width, line.size());
+    }
+
+    char at(size_t r, size_t c) const {
+        return c < lines[r].size() ? lines[r][c] : ' ';
+    }
+
+    bool is_separator(size_t c) const {
+        for (size_t r = 0; r < lines.size(); ++r) {
+            if (at(r, c) != ' ') return false;
+        }
+        return true;
+    }
+
+    // Calls fn(begin, end) for every problem, left to right.
+    template <typename Fn>
+    void for_each_block(Fn&& fn) const {
+        size_t begin = 0;
+        for (size_t c = 0; c <= width; ++c) {
+            if (c == width || is_separator(c)) {
+                if (begin < c) fn(begin, c);
+                begin = c + 1;
             }
         }
+    }
 
-        if (numbers.empty()) return;
+    size_t rows() const {
+        return lines.size();
+    }
 
-        unsigned long long result = numbers[0];
-        for (size_t i = 1; i < numbers.size(); ++i) {
-            if (op == '+')
-                result += numbers[i];
-            else if (op == '*')
-                result *= numbers[i];
-        }
-        grand_total += result;
-    };
+   private:
+    std::vector<std::string_view> lines;
+    size_t width = 0;
+};
+
+void fold_into(std::optional<Wide>& result, uint64_t value, char op) {
+    if (!result) {
+        result.emplace(value);
+    } else if (op == '+') {
+        *result += value;
+    } else if (op == '*') {
+        *result *= value;
+    }
+}
+
+void stream_sol(const fs::path& path) {
+    const aoc::MappedFile file(path);
+    const SlabCursor slab(file.view());
+    const size_t number_rows = slab.rows() - 1;
 
-    for (int c = static_cast<int>(max_width) - 1; c >= 0; --c) {
-        bool is_separator = true;
+    Wide answer_p1;
+    Wide answer_p2;
 
-        for (const auto& line : data) {
-            if (static_cast<size_t>(c) < line.size() && line[c] != ' ') {
-                is_separator = false;
-                break;
+    slab.for_each_block([&](size_t begin, size_t end) {
+        char op = ' ';
+        for (size_t c = end; c-- > begin && op == ' ';) op = slab.at(number_rows, c);
+
+        // Part 1: one number per row, read left to right.
+        std::optional<Wide> horizontal;
+        for (size_t r = 0; r < number_rows; ++r) {
+            uint64_t value = 0;
+            bool has_digits = false;
+            for (size_t c = begin; c < end; ++c) {
+                const auto digit = static_cast<unsigned char>(slab.at(r, c) - '0');
+                if (digit < 10) {
+                    value = append_digit(value, digit);
+                    has_digits = true;
+                }
             }
+            if (has_digits) fold_into(horizontal, value, op);
         }
 
-        if (is_separator) {
-            process_block(current_block_cols);
-            current_block_cols.clear();
-        } else {
-            current_block_cols.push_back(c);
+        // Part 2: one number per column, read right to left and top to bottom.
+        std::optional<Wide> vertical;
+        for (size_t c = end; c-- > begin;) {
+            uint64_t value = 0;
+            bool has_digits = false;
+            for (size_t r = 0; r < number_rows; ++r) {
+                const auto digit = static_cast<unsigned char>(slab.at(r, c) - '0');
+                if (digit < 10) {
+                    value = append_digit(value, digit);
+                    has_digits = true;
+                }
+            }
+            if (has_digits) fold_into(vertical, value, op);
         }
-    }
-
-    process_block(current_block_cols);
 
-    std::println("answer part 2: {}", grand_total);
+        if (horizontal) answer_p1 += *horizontal;
+        if (vertical) answer_p2 += *vertical;
+    });
 
-    return grand_total;
+    std::println("answer: {}", answer_p1.to_string());
+    std::println("answer part 2: {}", answer_p2.to_string());
 }
 
 int main(int argc, char* argv[]) {
     try {
         const auto start = std::chrono::high_resolution_clock::now();
 
-        std::string filename = (argc > 1) ? argv[1] : "input.txt";
-        auto data = aoc::read_lines(filename, "day_6");
+        std::string filename = "input.txt";
+        bool stream = false;
+        for (int i = 1; i < argc; ++i) {
+            if (std::string_view(argv[i]) == "--stream") {
+                stream = true;
+            } else {
+                filename = argv[i];
+            }
+        }
 
-        auto symbols = get_math_symbols(data[data.size() - 1]);
+        if (stream) {
+            stream_sol(aoc::resolve_file(filename, "day_6"));
+        } else {
+            auto data = aoc::read_lines(filename, "day_6");
 
-        part_one_sol(data, symbols);
-        part_two_sol(data, symbols);
+            part_one_sol(tokenize(data));
+            part_two_sol(transpose(data));
+        }
         const auto end = std::chrono::high_resolution_clock::now();
         const auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
 
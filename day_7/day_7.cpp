@@ -1,11 +1,14 @@
+#include <algorithm>
+#include <bit>
 #include <chrono>
 #include <cstddef>
+#include <cstdint>
 #include <filesystem>
 #include <iostream>
 #include <map>
 #include <ranges>
-#include <set>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "utils.h"
@@ -16,105 +19,135 @@ void print_map(std::map<size_t, bool>& m) {
     std::cout << '\n';
 }
 
-auto part_two_sol(const std::vector<std::string>& data) {
-    auto find_start = [&]() -> size_t {
-        for (auto [idx, c] : data[0] | std::views::enumerate) {
-            if (c == 'S') return idx;
-        }
-        return std::string::npos;
-    };
+struct BeamTotals {
+    unsigned long long splits = 0;
+    unsigned long long timelines = 0;
+};
 
-    size_t start_col = find_start();
-    if (start_col == std::string::npos) return 0ULL;
+size_t find_source(const std::string& line) {
+    for (auto [index, value] : line | std::views::enumerate) {
+        if (value == 'S') return index;
+    }
+    return std::string::npos;
+}
 
-    std::map<size_t, unsigned long long> timelines;
-    timelines[start_col] = 1;
+// Both parts in one pass. `current` holds the number of timelines reaching each column, with a
+// zero cell on either side so beams split off the edge simply vanish. Every row is computed
+// in gather form: a column keeps its own beams unless it is a splitter, and receives the beams
+// of splitting neighbours. No branches, no clearing, and the two buffers just swap roles.
+BeamTotals propagate_beams(const std::vector<std::string>& data) {
+    BeamTotals totals;
+    if (data.empty()) return totals;
 
-    for (size_t row = 0; row < data.size(); ++row) {
-        if (timelines.empty()) break;
+    const size_t start_col = find_source(data[0]);
+    if (start_col == std::string::npos) return totals;
 
-        std::map<size_t, unsigned long long> next_timelines;
+    size_t width = 0;
+    for (const auto& line : data) width = std::max(width, line.size());
 
-        for (auto const& [col, count] : timelines) {
-            char c = data[row][col];
+    std::vector<uint64_t> current(width + 2, 0);
+    std::vector<uint64_t> next(width + 2, 0);
+    std::vector<uint64_t> split(width + 2, 0);
+    current[start_col + 1] = 1;
 
-            if (c == '^') {
-                if (col > 0) {
-                    next_timelines[col - 1] += count;
-                }
-                if (col < data[row].size() - 1) {
-                    next_timelines[col + 1] += count;
-                }
-            } else {
-                next_timelines[col] += count;
-            }
+    for (const auto& line : data) {
+        for (size_t col = 0; col < line.size(); ++col) {
+            split[col + 1] = static_cast<uint64_t>(line[col] == '^');
         }
+        std::fill(split.begin() + 1 + static_cast<std::ptrdiff_t>(line.size()), split.end() - 1, 0);
 
-        timelines = std::move(next_timelines);
-    }
+        for (size_t col = 1; col <= width; ++col) {
+            totals.splits += split[col] & static_cast<uint64_t>(current[col] != 0);
+            next[col] = current[col] * (1 - split[col]) + current[col - 1] * split[col - 1] +
+                        current[col + 1] * split[col + 1];
+        }
 
-    unsigned long long total_timelines = 0;
-    for (const auto& [col, count] : timelines) {
-        total_timelines += count;
+        std::swap(current, next);
     }
 
-    return total_timelines;
+    for (size_t col = 1; col <= width; ++col) totals.timelines += current[col];
+    return totals;
 }
 
-auto part_one_sol(const std::vector<std::string>& data) {
-    unsigned long long answer = 0;
+// --- Bit-parallel part 1 ---
+//
+// Column `c` of a row is bit c % 64 of word c / 64. A whole row of beams advances with a few
+// word operations: beams off a splitter stay, beams on one move a column left and right.
 
-    auto find_source_index = [&]() -> size_t {
-        for (auto [index, value] : data[0] | std::views::enumerate) {
-            if (value == 'S') return index;
+// One splitter bitmask of `words` words per row, laid out row after row.
+std::vector<uint64_t> splitter_masks(const std::vector<std::string>& data, size_t words) {
+    std::vector<uint64_t> masks(data.size() * words, 0);
+    for (size_t row = 0; row < data.size(); ++row) {
+        uint64_t* mask = masks.data() + row * words;
+        for (size_t col = 0; col < data[row].size(); ++col) {
+            mask[col / 64] |= static_cast<uint64_t>(data[row][col] == '^') << (col % 64);
         }
-        return std::string::npos;
-    };
-
-    std::set<size_t> active_beams;
-    size_t start_idx = find_source_index();
-
-    if (start_idx != std::string::npos) {
-        active_beams.insert(start_idx);
     }
+    return masks;
+}
 
-    for (size_t i = 0; i < data.size(); ++i) {
-        if (active_beams.empty()) break;
+// next = (beams & ~split) | ((beams & split) << 1) | ((beams & split) >> 1), with the shifts
+// carried across words; the split count is popcount(beams & split).
+unsigned long long count_splits_bitwise(const std::vector<std::string>& data) {
+    if (data.empty()) return 0;
 
-        std::set<size_t> next_beams;
+    const size_t start_col = find_source(data[0]);
+    if (start_col == std::string::npos) return 0;
 
-        for (size_t col : active_beams) {
-            char c = data[i][col];
+    size_t width = 0;
+    for (const auto& line : data) width = std::max(width, line.size());
+    const size_t words = (width + 63) / 64;
+    const uint64_t tail = (width % 64 == 0) ? ~uint64_t{0} : (uint64_t{1} << (width % 64)) - 1;
 
-            if (c == '^') {
-                answer++;
+    const auto masks = splitter_masks(data, words);
+    std::vector<uint64_t> beams(words, 0);
+    std::vector<uint64_t> next(words, 0);
+    beams[start_col / 64] = uint64_t{1} << (start_col % 64);
 
-                if (col > 0) {
-                    next_beams.insert(col - 1);
-                }
-                if (col < data[i].size() - 1) {
-                    next_beams.insert(col + 1);
-                }
-            } else {
-                next_beams.insert(col);
-            }
+    unsigned long long splits = 0;
+    for (size_t row = 0; row < data.size(); ++row) {
+        const uint64_t* split = masks.data() + row * words;
+        auto hit = [&](size_t w) { return w < words ? beams[w] & split[w] : 0; };
+
+        for (size_t w = 0; w < words; ++w) {
+            const uint64_t here = hit(w);
+            const uint64_t below = w > 0 ? hit(w - 1) : 0;
+            splits += static_cast<unsigned long long>(std::popcount(here));
+            next[w] = (beams[w] & ~split[w]) | (here << 1) | (below >> 63) | (here >> 1) |
+                      (hit(w + 1) << 63);
         }
+        next[words - 1] &= tail;
 
-        active_beams = std::move(next_beams);
+        std::swap(beams, next);
     }
 
-    return answer;
+    return splits;
 }
 
 int main(int argc, char* argv[]) {
     try {
         const auto start = std::chrono::high_resolution_clock::now();
 
-        std::string filename = (argc > 1) ? argv[1] : "input.txt";
+        std::string filename = "input.txt";
+        bool bits = false;
+        for (int i = 1; i < argc; ++i) {
+            if (std::string_view(argv[i]) == "--bits") {
+                bits = true;
+            } else {
+                filename = argv[i];
+            }
+        }
         const auto& data = aoc::read_lines(filename, "day_7");
 
-        std::println("part 1 answer: {} ", part_one_sol(data));
-        std::println("part 2 answer: {} ", part_two_sol(data));
+        // --bits answers part 1 alone, so the dense pass is skipped entirely.
+        if (bits) {
+            std::println("part 1 answer: {} ", count_splits_bitwise(data));
+        } else {
+            const auto totals = propagate_beams(data);
+
+            std::println("part 1 answer: {} ", totals.splits);
+            std::println("part 2 answer: {} ", totals.timelines);
+        }
 
         const auto end = std::chrono::high_resolution_clock::now();
         const auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);